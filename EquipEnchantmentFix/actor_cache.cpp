@@ -0,0 +1,146 @@
+#include "pch.h"
+
+namespace EEF
+{
+	// map node + bucket slot + lru node + shared_ptr control block, close enough for MSVC's containers
+	static constexpr std::size_t ENTRY_OVERHEAD =
+		sizeof(std::pair<const Game::FormID, void*>) + sizeof(void*) * 4 +
+		sizeof(Game::FormID) + sizeof(void*) * 2 +
+		sizeof(void*) * 2;
+
+	std::size_t ActorStateCache::GetEntryBytes(const std::vector<WornEnchantment>& a_items) noexcept
+	{
+		return ENTRY_OVERHEAD +
+		       sizeof(Entry) +
+		       sizeof(a_items) +
+		       a_items.capacity() * sizeof(WornEnchantment);
+	}
+
+	void ActorStateCache::UpdateUsage()
+	{
+		m_bytes.store(
+			m_entryBytes + m_data.bucket_count() * sizeof(void*) * 2,
+			std::memory_order_relaxed);
+	}
+
+	auto ActorStateCache::Update(Game::FormID a_id, ActorState&& a_state)
+		-> WornItemsSnapshot
+	{
+		a_state.m_items.shrink_to_fit();
+
+		auto bytes = GetEntryBytes(a_state.m_items);
+
+		auto items = std::make_shared<const std::vector<WornEnchantment>>(std::move(a_state.m_items));
+
+		stl::scoped_lock lock(m_lock);
+
+		auto it = m_data.find(a_id);
+		if (it != m_data.end())
+		{
+			m_entryBytes -= it->second.bytes;
+
+			it->second.items = items;
+			it->second.bytes = bytes;
+
+			Touch(it->second);
+		}
+		else
+		{
+			m_lru.emplace_front(a_id);
+
+			m_data.emplace(a_id, Entry{ items, m_lru.begin(), bytes });
+		}
+
+		m_entryBytes += bytes;
+
+		UpdateUsage();
+
+		if (m_budget)
+		{
+			TrimImpl(m_budget);
+		}
+
+		return items;
+	}
+
+	void ActorStateCache::Erase(Game::FormID a_id)
+	{
+		stl::scoped_lock lock(m_lock);
+
+		auto it = m_data.find(a_id);
+		if (it == m_data.end())
+		{
+			return;
+		}
+
+		m_entryBytes -= it->second.bytes;
+		m_lru.erase(it->second.lru);
+		m_data.erase(it);
+
+		UpdateUsage();
+	}
+
+	void ActorStateCache::Clear()
+	{
+		stl::scoped_lock lock(m_lock);
+
+		decltype(m_data)().swap(m_data);
+		m_lru.clear();
+		m_entryBytes = 0;
+
+		UpdateUsage();
+	}
+
+	bool ActorStateCache::Get(Game::FormID a_id, WornItemsSnapshot& a_out)
+	{
+		stl::scoped_lock lock(m_lock);
+
+		auto it = m_data.find(a_id);
+		if (it == m_data.end())
+		{
+			return false;
+		}
+
+		Touch(it->second);
+
+		a_out = it->second.items;
+
+		return true;
+	}
+
+	std::size_t ActorStateCache::Trim(std::size_t a_limit)
+	{
+		stl::scoped_lock lock(m_lock);
+		return TrimImpl(a_limit);
+	}
+
+	std::size_t ActorStateCache::TrimImpl(std::size_t a_limit)
+	{
+		std::size_t evicted = 0;
+
+		while (!m_lru.empty() &&
+		       m_bytes.load(std::memory_order_relaxed) > a_limit)
+		{
+			auto it = m_data.find(m_lru.back());
+			if (it != m_data.end())
+			{
+				m_entryBytes -= it->second.bytes;
+				m_data.erase(it);
+			}
+
+			m_lru.pop_back();
+
+			UpdateUsage();
+
+			evicted++;
+		}
+
+		if (evicted && m_data.bucket_count() > m_data.size() * 4 + 64)
+		{
+			m_data.rehash(0);
+			UpdateUsage();
+		}
+
+		return evicted;
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+namespace EEF
+{
+	struct ActorState
+	{
+		std::vector<WornEnchantment> m_items;
+	};
+
+	// a cached entry's items, never modified once cached, readers keep theirs alive
+	// across replacement and eviction
+	using WornItemsSnapshot = std::shared_ptr<const std::vector<WornEnchantment>>;
+
+	class ActorStateCache
+	{
+		using lru_list_t = std::list<Game::FormID>;
+
+		struct Entry
+		{
+			WornItemsSnapshot items;
+			lru_list_t::iterator lru;
+			std::size_t bytes;
+		};
+
+	public:
+		// returns the snapshot now cached for a_id
+		WornItemsSnapshot Update(Game::FormID a_id, ActorState&& a_state);
+		void Erase(Game::FormID a_id);
+		void Clear();
+
+		// hands out a reference instead of the entry so callers never run foreign code under m_lock
+		bool Get(Game::FormID a_id, WornItemsSnapshot& a_out);
+
+		void SetBudget(std::size_t a_bytes) noexcept
+		{
+			m_budget = a_bytes;
+		}
+
+		[[nodiscard]] std::size_t GetBudget() const noexcept
+		{
+			return m_budget;
+		}
+
+		// shrinks to a_limit bytes, returns the number of evicted entries
+		std::size_t Trim(std::size_t a_limit);
+
+		[[nodiscard]] std::size_t GetUsage() const noexcept
+		{
+			return m_bytes.load(std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] std::size_t GetSize() const
+		{
+			stl::scoped_lock lock(m_lock);
+			return m_data.size();
+		}
+
+	private:
+		static std::size_t GetEntryBytes(const std::vector<WornEnchantment>& a_items) noexcept;
+
+		SKMP_FORCEINLINE void Touch(Entry& a_entry)
+		{
+			m_lru.splice(m_lru.begin(), m_lru, a_entry.lru);
+		}
+
+		void UpdateUsage();
+		std::size_t TrimImpl(std::size_t a_limit);
+
+		mutable stl::critical_section m_lock;
+		std::unordered_map<Game::FormID, Entry> m_data;
+		lru_list_t m_lru;
+		std::size_t m_entryBytes{ 0 };
+		std::atomic<std::size_t> m_bytes{ 0 };
+		std::size_t m_budget{ 0 };
+	};
+}
@@ -0,0 +1,200 @@
+#include "pch.h"
+
+namespace EEF
+{
+	static void SplitList(const char* a_in, std::vector<std::string>& a_out)
+	{
+		if (!a_in)
+			return;
+
+		std::string current;
+
+		for (auto p = a_in;; p++)
+		{
+			if (*p == ',' || *p == 0)
+			{
+				auto first = current.find_first_not_of(" \t");
+				if (first != std::string::npos)
+				{
+					auto last = current.find_last_not_of(" \t");
+					a_out.emplace_back(current.substr(first, last - first + 1));
+				}
+
+				current.clear();
+
+				if (*p == 0)
+					break;
+			}
+			else
+			{
+				current += *p;
+			}
+		}
+	}
+
+	void ActorFilter::Configure(const char* a_excludeRaces, const char* a_excludeKeywords)
+	{
+		m_enabled = true;
+
+		SplitList(a_excludeRaces, m_excludeRaceIDs);
+		SplitList(a_excludeKeywords, m_excludeKeywordIDs);
+	}
+
+	bool ActorFilter::HasAnyKeyword(BGSKeywordForm& a_form, const std::vector<BGSKeyword*>& a_keywords)
+	{
+		for (auto& e : a_keywords)
+		{
+			if (a_form.HasKeyword(e))
+				return true;
+		}
+
+		return false;
+	}
+
+	void ActorFilter::Build()
+	{
+		if (!m_enabled)
+			return;
+
+		auto dh = DataHandler::GetSingleton();
+
+		std::vector<BGSKeyword*> keywords;
+
+		for (auto& e : dh->arrKYWD)
+		{
+			if (!e)
+				continue;
+
+			auto edid = e->keyword.Get();
+			if (!edid)
+				continue;
+
+			for (auto& f : m_excludeKeywordIDs)
+			{
+				if (_stricmp(edid, f.c_str()) == 0)
+				{
+					keywords.emplace_back(e);
+					break;
+				}
+			}
+		}
+
+		// a race can only wear armor some non-skin armor addon was made for
+		std::unordered_set<const TESObjectARMO*> skins;
+
+		for (auto& e : dh->arrRACE)
+		{
+			if (e && e->skin)
+				skins.emplace(e->skin);
+		}
+
+		for (auto& e : dh->arrNPC_)
+		{
+			if (e && e->skin)
+				skins.emplace(e->skin);
+		}
+
+		std::unordered_set<const TESRace*> armorableRaces;
+
+		for (auto& e : dh->arrARMO)
+		{
+			if (!e || skins.contains(e))
+				continue;
+
+			for (auto& f : e->armorAddons)
+			{
+				if (!f)
+					continue;
+
+				if (f->race.race)
+					armorableRaces.emplace(f->race.race);
+
+				for (auto& g : f->additionalRaces)
+				{
+					if (g)
+						armorableRaces.emplace(g);
+				}
+			}
+		}
+
+		std::size_t noArmorRaces = 0;
+
+		for (auto& e : dh->arrRACE)
+		{
+			if (!e)
+				continue;
+
+			if (!armorableRaces.contains(e))
+			{
+				m_excludedRaces.emplace(e);
+				noArmorRaces++;
+				continue;
+			}
+
+			if (HasAnyKeyword(e->keyword, keywords))
+			{
+				m_excludedRaces.emplace(e);
+				continue;
+			}
+
+			auto edid = e->editorId.Get();
+			if (!edid)
+				continue;
+
+			for (auto& f : m_excludeRaceIDs)
+			{
+				if (_stricmp(edid, f.c_str()) == 0)
+				{
+					m_excludedRaces.emplace(e);
+					break;
+				}
+			}
+		}
+
+		for (auto& e : dh->arrNPC_)
+		{
+			if (!e)
+				continue;
+
+			if (HasAnyKeyword(e->keyword, keywords))
+			{
+				m_excludedNPCs.emplace(e);
+			}
+		}
+
+		gLog.Message(
+			"ActorPreFilter: %zu races excluded (%zu without armor addons), %zu/%u NPCs excluded",
+			m_excludedRaces.size(),
+			noArmorRaces,
+			m_excludedNPCs.size(),
+			dh->arrNPC_.count);
+
+		m_excludeRaceIDs.clear();
+		m_excludeKeywordIDs.clear();
+	}
+
+	bool ActorFilter::Accept(Actor* a_actor) const
+	{
+		if (!m_enabled)
+			return true;
+
+		// items handed over at runtime aren't visible in base data
+		if (a_actor == *g_thePlayer ||
+		    (a_actor->flags1 & Actor::kFlags_IsPlayerTeammate) != 0)
+		{
+			return true;
+		}
+
+		auto npc = a_actor->baseForm ? a_actor->baseForm->As<TESNPC>() : nullptr;
+		if (!npc)
+			return true;
+
+		// the live race, it can differ from the base form's after a runtime race change
+		auto race = a_actor->race ? a_actor->race : npc->race.race;
+
+		if (m_excludedRaces.contains(race))
+			return false;
+
+		return !m_excludedNPCs.contains(npc);
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+namespace EEF
+{
+	// Rejects actors that can never wear enchanted armor before they're queued for validation.
+	// Only structural data is used: races no armor addon was made for, plus races and NPCs
+	// excluded in the INI. What an NPC carries or wears is save-game state (outfit changes,
+	// scripted or looted gear) and is never judged from base data.
+	class ActorFilter
+	{
+	public:
+		void Configure(const char* a_excludeRaces, const char* a_excludeKeywords);
+		void Build();
+
+		[[nodiscard]] bool Accept(Actor* a_actor) const;
+
+		[[nodiscard]] SKMP_FORCEINLINE bool IsEnabled() const noexcept
+		{
+			return m_enabled;
+		}
+
+	private:
+		static bool HasAnyKeyword(BGSKeywordForm& a_form, const std::vector<BGSKeyword*>& a_keywords);
+
+		bool m_enabled{ false };
+
+		std::vector<std::string> m_excludeRaceIDs;
+		std::vector<std::string> m_excludeKeywordIDs;
+
+		std::unordered_set<const TESRace*> m_excludedRaces;
+		std::unordered_set<const TESNPC*> m_excludedNPCs;
+	};
+}
@@ -0,0 +1,91 @@
+#include "pch.h"
+
+namespace EEF
+{
+	static constexpr std::size_t MAX_WARMUP_THREADS = 4;
+	static constexpr std::size_t MIN_ACTORS_PER_THREAD = 8;
+
+	void ActorWarmup::Run(const std::vector<Game::ObjectRefHandle>& a_handles)
+	{
+		Clear();
+
+		if (a_handles.empty())
+			return;
+
+		using result_t = std::vector<Game::FormID>;
+
+		auto hw = static_cast<std::size_t>(std::max(std::thread::hardware_concurrency(), 1u));
+		auto numThreads = std::clamp<std::size_t>(
+			a_handles.size() / MIN_ACTORS_PER_THREAD,
+			1,
+			std::min(hw, MAX_WARMUP_THREADS));
+
+		std::vector<result_t> results(numThreads);
+		std::vector<std::thread> threads;
+		threads.reserve(numThreads);
+
+		for (std::size_t t = 0; t < numThreads; t++)
+		{
+			threads.emplace_back([&, t] {
+				TraceScope ts(TraceProfiler::Span::kWarmup, nullptr);
+
+				auto& out = results[t];
+
+				for (auto i = t; i < a_handles.size(); i += numThreads)
+				{
+					NiPointer<TESObjectREFR> ref;
+					if (!a_handles[i].Lookup(ref))
+						continue;
+
+					auto actor = ref->As<Actor>();
+					if (!actor || actor->IsDeleted() || actor->IsDead())
+						continue;
+
+					auto containerChanges = actor->extraData.Get<ExtraContainerChanges>();
+					if (!containerChanges ||
+					    !containerChanges->data ||
+					    !containerChanges->data->objList)
+					{
+						continue;
+					}
+
+					// the collector takes each extra list's BSReadLocker, same as on the main thread
+					EquippedEnchantedItemCollector collector;
+
+					{
+						TraceScope tsv(TraceProfiler::Span::kInventoryVisit, actor);
+						containerChanges->data->objList->Visit(collector);
+					}
+
+					bool bare = std::none_of(
+						collector.m_results.begin(),
+						collector.m_results.end(),
+						[](auto& a_e) { return a_e.m_form->formType == TESObjectARMO::kTypeID; });
+
+					if (bare)
+						out.emplace_back(actor->formID);
+				}
+			});
+		}
+
+		for (auto& e : threads)
+		{
+			e.join();
+		}
+
+		for (auto& e : results)
+		{
+			m_data.insert(e.begin(), e.end());
+		}
+	}
+
+	bool ActorWarmup::TakeBare(Game::FormID a_id)
+	{
+		return m_data.erase(a_id) != 0;
+	}
+
+	void ActorWarmup::Clear()
+	{
+		decltype(m_data)().swap(m_data);
+	}
+}
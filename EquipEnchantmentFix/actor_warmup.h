@@ -0,0 +1,28 @@
+#pragma once
+
+namespace EEF
+{
+	// Walks the inventories of queued actors on worker threads after a load and records
+	// the ones wearing no enchanted armor, so the first EnchantmentEnforcerTask run can
+	// skip them. Nothing else is kept: extra lists and effects may change or be freed
+	// before the task runs, actors with worn items are always re-read on the main thread.
+	class ActorWarmup
+	{
+	public:
+		// blocks until all workers finish, main thread only
+		void Run(const std::vector<Game::ObjectRefHandle>& a_handles);
+
+		// true if the actor was found wearing no enchanted armor
+		bool TakeBare(Game::FormID a_id);
+
+		void Clear();
+
+		[[nodiscard]] SKMP_FORCEINLINE bool HasData() const noexcept
+		{
+			return !m_data.empty();
+		}
+
+	private:
+		std::unordered_set<Game::FormID> m_data;
+	};
+}
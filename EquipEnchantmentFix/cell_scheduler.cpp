@@ -0,0 +1,101 @@
+#include "pch.h"
+
+namespace EEF
+{
+	Game::FormID CellBatchScheduler::GetCellID(TESObjectREFR* a_ref)
+	{
+		return a_ref->parentCell ? a_ref->parentCell->formID : 0;
+	}
+
+	bool CellBatchScheduler::OnAttach(Actor* a_actor)
+	{
+		auto handle = a_actor->GetHandle();
+		if (!handle || !handle.IsValid())
+		{
+			return false;
+		}
+
+		stl::scoped_lock lock(m_lock);
+
+		// a non-empty map means a Run is already pending
+		bool submit = m_pending.empty();
+
+		auto cellID = GetCellID(a_actor);
+
+		// an actor re-attached elsewhere before the drain stays in its first batch
+		if (m_cells.emplace(handle, cellID).second)
+		{
+			m_pending[cellID].emplace_back(handle);
+		}
+
+		return submit;
+	}
+
+	bool CellBatchScheduler::OnDetach(TESObjectREFR* a_ref)
+	{
+		auto handle = a_ref->GetHandle();
+		if (!handle)
+		{
+			return false;
+		}
+
+		bool result = false;
+
+		{
+			stl::scoped_lock lock(m_lock);
+
+			// the actor may have moved since it was batched, its current parentCell is no use here
+			auto it = m_cells.find(handle);
+			if (it != m_cells.end())
+			{
+				auto& batch = m_pending[it->second];
+
+				auto it2 = std::find(batch.begin(), batch.end(), handle);
+				if (it2 != batch.end())
+				{
+					*it2 = batch.back();
+					batch.pop_back();
+				}
+
+				m_cells.erase(it);
+
+				result = true;
+			}
+		}
+
+		return m_target.Cancel(handle) || result;
+	}
+
+	void CellBatchScheduler::Clear()
+	{
+		stl::scoped_lock lock(m_lock);
+		m_pending.clear();
+		m_cells.clear();
+	}
+
+	void CellBatchScheduler::Run()
+	{
+		decltype(m_pending) pending;
+
+		{
+			stl::scoped_lock lock(m_lock);
+			pending.swap(m_pending);
+			m_cells.clear();
+		}
+
+		bool submit = false;
+
+		for (auto& e : pending)
+		{
+			if (!e.second.empty())
+			{
+				submit |= m_target.AddBatch(e.second);
+			}
+		}
+
+		if (submit)
+		{
+			ISKSE::GetSingleton().GetInterface<SKSETaskInterface>()->AddTask(std::addressof(m_target));
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+namespace EEF
+{
+	// Groups actors attached during a frame by their parent cell and hands each cell to the
+	// enforcer queue as a single batch on the next task drain. Actors whose cell detaches
+	// before their batch was processed are dropped from it and from the queue.
+	class CellBatchScheduler :
+		public TaskDelegate
+	{
+	public:
+		explicit CellBatchScheduler(EnchantmentEnforcerTask& a_target) :
+			m_target(a_target)
+		{
+		}
+
+		virtual void Run() override;
+		virtual void Dispose() override{};
+
+		// returns true if the task must be submitted
+		bool OnAttach(Actor* a_actor);
+
+		// returns true if pending work for a_ref was cancelled
+		bool OnDetach(TESObjectREFR* a_ref);
+
+		void Clear();
+
+	private:
+		static Game::FormID GetCellID(TESObjectREFR* a_ref);
+
+		stl::critical_section m_lock;
+		std::unordered_map<Game::FormID, std::vector<Game::ObjectRefHandle>> m_pending;
+		std::unordered_map<Game::ObjectRefHandle, Game::FormID> m_cells;  // batch each pending handle is in
+		EnchantmentEnforcerTask& m_target;
+	};
+}
@@ -77,7 +77,11 @@ extern "C" {
 		bool ret = Initialize(a_skse);
 
 		IAL::Release();
-		gLog.Close();
+
+		if (!EEF::NeedsRuntimeLog())
+		{
+			gLog.Close();
+		}
 
 		return ret;
 	}
@@ -4,12 +4,43 @@ namespace EEF
 {
 	static EnchantmentEnforcerTask s_eft;
 	static PlayerInvWeightRecalcTask s_wrct;
+	static DeferredDispelTask s_dispelTask;
+	static CellBatchScheduler s_cellScheduler(s_eft);
+	static ActorStateCache s_actorCache;
+	static ActorFilter s_actorFilter;
+	static ActorWarmup s_warmup;
+#ifdef _DEBUG
+	static SchedulerBenchmark::Config s_benchmark{};
+#endif
 
 	static bool s_validateOnEffectRemoved;
 	static bool s_validateOnLoad;
 	static bool s_doRecalcWeight;
+	static bool s_dispelOnUnequip;
+	static bool s_postLoadWarmup;
+	static bool s_debounceAddRemoveDispel;
+	static bool s_cellAwareScheduling;
 
 	static bool s_triggeredWeightRecalc = false;
+	static bool s_runtimeLog = false;
+
+	// the actor state cache only has a reader once another plugin holds IQueryInterface
+	static std::atomic<bool> s_actorCacheEnabled{ false };
+
+	static constexpr long DEFAULT_MEMORY_BUDGET_KB = 1024;
+
+	static DWORD s_mainThreadId;
+
+	// sampled verification time inside the current EnchantmentEnforcerTask::Run, main thread only
+	static std::uint64_t s_runVerifyOverhead = 0;
+
+	SKMP_FORCEINLINE static bool IsMainThread()
+	{
+		return ::GetCurrentThreadId() == s_mainThreadId;
+	}
+
+	// bucket arrays larger than this are released once the queue drains
+	static constexpr std::size_t QUEUE_SHRINK_BUCKETS = 512;
 
 	static bool IsREFRValid(TESObjectREFR* a_refr)
 	{
@@ -18,6 +49,19 @@ namespace EEF
 		       !a_refr->IsDead();
 	}
 
+	SKMP_FORCEINLINE static bool IsEnchantableItemType(std::uint8_t a_formType)
+	{
+		switch (a_formType)
+		{
+		case TESObjectARMO::kTypeID:
+		case TESObjectWEAP::kTypeID:
+		case TESAmmo::kTypeID:
+			return true;
+		default:
+			return false;
+		}
+	}
+
 	static EnchantmentItem* GetEnchantment(
 		TESForm* a_form,
 		BaseExtraList* a_extraData)
@@ -37,6 +81,8 @@ namespace EEF
 		TESForm* a_form,
 		EnchantmentItem* a_enchantment)
 	{
+		TraceScope ts(TraceProfiler::Span::kEffectScan, a_actor);
+
 		auto effects = a_actor->GetActiveEffectList();
 		if (!effects)
 			return false;
@@ -58,12 +104,79 @@ namespace EEF
 		return false;
 	}
 
-	bool EquippedEnchantedArmorItemCollector::Accept(InventoryEntryData* a_entryData)
+	static void DispelItemEffects(
+		Actor* a_actor,
+		TESForm* a_form)
+	{
+		TraceScope ts(TraceProfiler::Span::kDispel, a_actor);
+
+		auto effects = a_actor->GetActiveEffectList();
+		if (!effects)
+			return;
+
+		for (auto& effect : *effects)
+		{
+			if (!effect)
+			{
+				continue;
+			}
+
+			if (effect->source == a_form &&
+			    effect->spell &&
+			    !(effect->flags.test(ActiveEffect::Flag::kDispelled)))
+			{
+				effect->Dispel(false);
+				Metrics::Inc(Metrics::Counter::kEffectsDispelled);
+			}
+		}
+	}
+
+	void ActiveItemEffects::Collect(Actor* a_actor)
+	{
+		TraceScope ts(TraceProfiler::Span::kEffectScan, a_actor);
+
+		auto effects = a_actor->GetActiveEffectList();
+		if (!effects)
+			return;
+
+		for (auto& effect : *effects)
+		{
+			if (!effect)
+			{
+				continue;
+			}
+
+			// weapon-sourced effects on an actor are hits taken from someone else's weapon
+			if (effect->source &&
+			    effect->spell &&
+			    effect->source->formType == TESObjectARMO::kTypeID)
+			{
+				m_data.emplace_back(effect->source, effect->spell);
+			}
+		}
+	}
+
+	bool ActiveItemEffects::Contains(
+		TESForm* a_form,
+		EnchantmentItem* a_enchantment) const
+	{
+		for (auto& e : m_data)
+		{
+			if (e.first == a_form && e.second == a_enchantment)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool EquippedEnchantedItemCollector::Accept(InventoryEntryData* a_entryData)
 	{
 		if (!a_entryData || !a_entryData->type)
 			return true;
 
-		if (a_entryData->type->formType != TESObjectARMO::kTypeID)
+		if (!IsEnchantableItemType(a_entryData->type->formType))
 			return true;
 
 		auto extendDataList = a_entryData->extendDataList;
@@ -199,6 +312,91 @@ namespace EEF
 		return false;
 	}
 
+	// re-runs the reference inventory walk and per-item ability lookup, then compares the
+	// worn item set and the resulting fix decisions against what an optimized path produced,
+	// a_items is null when the path skipped the actor without building an item list
+	// returns the time spent, for callers to keep out of their own timings
+	static std::uint64_t ShadowVerify(
+		const char* a_path,
+		Actor* a_actor,
+		const std::vector<WornEnchantment>* a_items)
+	{
+		MetricsScope ms(Metrics::Probe::kShadowVerify);
+		TraceScope ts(TraceProfiler::Span::kShadowVerify, a_actor);
+
+		auto start = std::chrono::steady_clock::now();
+
+		auto containerChanges = a_actor->extraData.Get<ExtraContainerChanges>();
+		if (containerChanges &&
+		    containerChanges->data &&
+		    containerChanges->data->objList)
+		{
+			EquippedEnchantedItemCollector collector;
+			containerChanges->data->objList->Visit(collector);
+
+			for (auto& e : collector.m_results)
+			{
+				const WornEnchantment* listed = nullptr;
+
+				if (a_items)
+				{
+					auto it = std::find_if(
+						a_items->begin(),
+						a_items->end(),
+						[&](auto& a_f) {
+							return a_f.form == e.m_form &&
+						           a_f.enchantment == e.m_enchantment;
+						});
+
+					if (it != a_items->end())
+						listed = std::addressof(*it);
+
+					ShadowVerifier::Check(a_path, "worn", a_actor, e.m_form, listed != nullptr, true);
+				}
+
+				if (e.m_form->formType != TESObjectARMO::kTypeID)
+					continue;
+
+				// an item the fast path never saw is one it decided not to fix
+				ShadowVerifier::Check(
+					a_path,
+					"needs fix",
+					a_actor,
+					e.m_form,
+					listed && !listed->active,
+					!HasItemAbility(a_actor, e.m_form, e.m_enchantment));
+			}
+
+			if (a_items)
+			{
+				for (auto& e : *a_items)
+				{
+					bool worn = std::any_of(
+						collector.m_results.begin(),
+						collector.m_results.end(),
+						[&](auto& a_f) {
+							return a_f.m_form == e.form &&
+						           a_f.m_enchantment == e.enchantment;
+						});
+
+					if (!worn)
+					{
+						ShadowVerifier::Check(a_path, "worn", a_actor, e.form, true, false);
+					}
+				}
+			}
+		}
+
+		auto elapsed = static_cast<std::uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - start)
+				.count());
+
+		ShadowVerifier::AddOverhead(elapsed);
+
+		return elapsed;
+	}
+
 	static void ScheduleEFT(TESObjectREFR* a_ref)
 	{
 		auto handle = a_ref->GetHandle();
@@ -209,39 +407,222 @@ namespace EEF
 
 		if (s_eft.Add(handle))
 		{
+			Metrics::CacheResult(Metrics::Cache::kScheduleDedup, false);
 			ISKSE::GetSingleton().GetInterface<SKSETaskInterface>()->AddTask(&s_eft);
 		}
+		else
+		{
+			Metrics::CacheResult(Metrics::Cache::kScheduleDedup, true);
+		}
+	}
+
+	bool EnchantmentEnforcerTask::AddBatch(
+		const std::uint32_t* a_handles,
+		std::uint32_t a_count,
+		RevalidateCallback_t a_callback,
+		void* a_user)
+	{
+		stl::scoped_lock lock(m_lock);
+
+		// a non-empty queue means a Run is already pending
+		bool submit = m_data.empty() && m_callbacks.empty();
+
+		m_data.reserve(m_data.size() + a_count);
+
+		for (std::uint32_t i = 0; i < a_count; i++)
+		{
+			Game::ObjectRefHandle handle(a_handles[i]);
+			if (handle && handle.IsValid())
+			{
+				m_data.emplace(handle);
+			}
+		}
+
+		if (a_callback)
+		{
+			m_callbacks.emplace_back(a_callback, a_user);
+		}
+
+		ReportQueueDepth();
+
+		return submit && (!m_data.empty() || !m_callbacks.empty());
+	}
+
+	bool EnchantmentEnforcerTask::AddBatch(const std::vector<Game::ObjectRefHandle>& a_handles)
+	{
+		stl::scoped_lock lock(m_lock);
+
+		bool submit = m_data.empty() && m_callbacks.empty();
+
+		m_data.insert(a_handles.begin(), a_handles.end());
+
+		ReportQueueDepth();
+
+		return submit && !m_data.empty();
+	}
+
+	static void ScheduleLoadedActor(Actor* a_actor)
+	{
+		if (!s_actorFilter.Accept(a_actor))
+		{
+			Metrics::Inc(Metrics::Counter::kActorsFiltered);
+			return;
+		}
+
+		if (s_cellAwareScheduling)
+		{
+			if (s_cellScheduler.OnAttach(a_actor))
+			{
+				ISKSE::GetSingleton().GetInterface<SKSETaskInterface>()->AddTask(&s_cellScheduler);
+			}
+
+			return;
+		}
+
+		ScheduleEFT(a_actor);
 	}
 
 	static void ClearEFTData()
 	{
-		s_eft.m_data.clear();
+		decltype(s_eft.m_callbacks) callbacks;
+
+		{
+			stl::scoped_lock lock(s_eft.m_lock);
+
+			s_eft.m_data.clear();
+			callbacks.swap(s_eft.m_callbacks);
+
+			Metrics::SetQueueDepth(0);
+		}
+
+		// the batches are abandoned, but their owners still get to know they're done
+		for (auto& e : callbacks)
+		{
+			e.first(e.second);
+		}
+
+		s_cellScheduler.Clear();
+		s_actorCache.Clear();
+		s_warmup.Clear();
+	}
+
+	static void WarmupQueuedActors()
+	{
+		std::vector<Game::ObjectRefHandle> handles;
+
+		{
+			stl::scoped_lock lock(s_eft.m_lock);
+
+			handles.reserve(s_eft.m_data.size());
+			handles.insert(handles.end(), s_eft.m_data.begin(), s_eft.m_data.end());
+		}
+
+		s_warmup.Run(handles);
+	}
+
+	static void LogMemoryUsage(const char* a_context)
+	{
+		std::size_t queueBytes;
+
+		{
+			stl::scoped_lock lock(s_eft.m_lock);
+			queueBytes = s_eft.GetUsage();
+		}
+
+		gLog.Message(
+			"[%s] memory: cache %zu actors / %zu bytes, queue %zu bytes, budget %zu bytes",
+			a_context,
+			s_actorCache.GetSize(),
+			s_actorCache.GetUsage(),
+			queueBytes,
+			s_actorCache.GetBudget());
+	}
+
+	std::size_t EnchantmentEnforcerTask::GetUsage() const noexcept
+	{
+		return m_data.bucket_count() * sizeof(void*) * 2 +
+		       m_data.size() * (sizeof(Game::ObjectRefHandle) + sizeof(void*) * 2);
 	}
 
 	void EnchantmentEnforcerTask::Run()
 	{
-		stl::scoped_lock lock(m_lock);
+		MetricsScope ms(Metrics::Probe::kTaskRun);
+		TraceScope ts(TraceProfiler::Span::kTaskRun, nullptr);
+
+		decltype(m_callbacks) callbacks;
+
+		s_runVerifyOverhead = 0;
+
+		{
+			stl::scoped_lock lock(m_lock);
+
+			RunImpl();
+
+			callbacks.swap(m_callbacks);
+		}
+
+		ms.Exclude(s_runVerifyOverhead);
 
+		for (auto& e : callbacks)
+		{
+			e.first(e.second);
+		}
+	}
+
+	void EnchantmentEnforcerTask::RunImpl()
+	{
 		if (m_data.empty())
 			return;
 
-		for (const auto& e : m_data)
-		{
+		DrainImpl([](Game::ObjectRefHandle a_handle) {
 			NiPointer<TESObjectREFR> ref;
-			if (e.Lookup(ref))
+			if (a_handle.Lookup(ref))
 			{
 				if (auto actor = ref->As<Actor>())
 				{
 					ProcessActor(actor);
 				}
 			}
+		});
+
+		// skip hints are only trusted for the first run after a load
+		s_warmup.Clear();
+
+		bool shrunk = false;
+
+		if (m_data.bucket_count() > QUEUE_SHRINK_BUCKETS)
+		{
+			decltype(m_data)().swap(m_data);
+			shrunk = true;
 		}
 
-		m_data.clear();
+		std::size_t evicted = 0;
+
+		if (auto budget = s_actorCache.GetBudget())
+		{
+			auto queueBytes = GetUsage();
+			evicted = s_actorCache.Trim(budget > queueBytes ? budget - queueBytes : 0);
+		}
+
+		Metrics::SetMemoryUsage(s_actorCache.GetUsage(), GetUsage());
+
+		if (s_runtimeLog && (shrunk || evicted))
+		{
+			gLog.Message(
+				"Trimmed: queue %s, %zu cache entries evicted, cache %zu bytes, queue %zu bytes",
+				shrunk ? "released" : "kept",
+				evicted,
+				s_actorCache.GetUsage(),
+				GetUsage());
+		}
 	}
 
 	void EnchantmentEnforcerTask::ProcessActor(Actor* a_actor)
 	{
+		MetricsScope ms(Metrics::Probe::kProcessActor);
+		SlowOpScope sos(SlowOpLog::Op::kProcessActor, a_actor);
+		TraceScope ts(TraceProfiler::Span::kProcessActor, a_actor);
+
 		if (!IsREFRValid(a_actor))
 			return;
 
@@ -255,24 +636,94 @@ namespace EEF
 			return;
 		}
 
-		EquippedEnchantedArmorItemCollector collector;
-		containerChanges->data->objList->Visit(collector);
+		if (s_warmup.HasData())
+		{
+			bool bare = s_warmup.TakeBare(a_actor->formID);
+
+			Metrics::CacheResult(Metrics::Cache::kWarmup, bare);
+
+			// anything equipped since the warmup walk went through TESEquipEvent
+			if (bare)
+			{
+				Metrics::Inc(Metrics::Counter::kActorsValidated);
+
+				if (ShadowVerifier::ShouldSample())
+				{
+					auto overhead = ShadowVerify("warmup", a_actor, nullptr);
+
+					ms.Exclude(overhead);
+					sos.Exclude(overhead);
+					s_runVerifyOverhead += overhead;
+				}
+
+				return;
+			}
+		}
+
+		EquippedEnchantedItemCollector collector;
+
+		{
+			TraceScope tsv(TraceProfiler::Span::kInventoryVisit, a_actor);
+			containerChanges->data->objList->Visit(collector);
+		}
+
+		ActiveItemEffects effects;
+		effects.Collect(a_actor);
+
+		Metrics::Inc(Metrics::Counter::kActorsValidated);
+
+		ActorState state;
+		state.m_items.reserve(collector.m_results.size());
 
 		for (auto& e : collector.m_results)
 		{
-			if (!HasItemAbility(a_actor, e.m_form, e.m_enchantment))
+			state.m_items.emplace_back(WornEnchantment{
+				e.m_form,
+				e.m_enchantment,
+				effects.Contains(e.m_form, e.m_enchantment) });
+		}
+
+		if (ShadowVerifier::ShouldSample())
+		{
+			// counted as shadow_verify, not as part of this call
+			auto overhead = ShadowVerify("effect index", a_actor, std::addressof(state.m_items));
+
+			ms.Exclude(overhead);
+			sos.Exclude(overhead);
+			s_runVerifyOverhead += overhead;
+		}
+
+		for (std::size_t i = 0; i < collector.m_results.size(); i++)
+		{
+			auto& e = collector.m_results[i];
+			auto& f = state.m_items[i];
+
+			// weapon and ammo enchantments are delivered on hit, only armor carries an ability
+			if (!f.active && e.m_form->formType == TESObjectARMO::kTypeID)
 			{
+				TraceScope tsu(TraceProfiler::Span::kUpdateArmorAbility, a_actor);
+
 				a_actor->UpdateArmorAbility(e.m_form, e.m_extraList);
+				Metrics::Inc(Metrics::Counter::kFixesApplied);
+
+				// reported as validated, so look rather than assume the fix took
+				f.active = HasItemAbility(a_actor, e.m_form, e.m_enchantment);
 			}
 		}
+
+		if (s_actorCacheEnabled.load(std::memory_order_relaxed))
+			s_actorCache.Update(a_actor->formID, std::move(state));
 	}
 
 	void EEFEventHandler::HandleEvent(const TESEquipEvent* a_evn)
 	{
-		if (!a_evn->equipped)
+		if (a_evn->actor == nullptr)
 			return;
 
-		if (a_evn->actor == nullptr)
+		if (s_actorCacheEnabled.load(std::memory_order_relaxed))
+			s_actorCache.Erase(a_evn->actor->formID);
+
+		if (!a_evn->equipped && !s_dispelOnUnequip)
 			return;
 
 		if (!IsREFRValid(a_evn->actor))
@@ -286,6 +737,7 @@ namespace EEF
 		if (!form)
 			return;
 
+		// weapon/ammo enchantments apply on hit, the wearer has no effect of theirs to manage
 		if (form->formType != TESObjectARMO::kTypeID)
 			return;
 
@@ -294,7 +746,20 @@ namespace EEF
 			return;
 
 		FindEquippedArmorItemVisitor visitor(form);
-		containerChanges->data->objList->Visit(visitor);
+
+		{
+			TraceScope ts(TraceProfiler::Span::kInventoryVisit, actor);
+			containerChanges->data->objList->Visit(visitor);
+		}
+
+		if (!a_evn->equipped)
+		{
+			// only clean up once the last worn instance is gone
+			if (!visitor.m_result.m_match)
+				DispelItemEffects(actor, form);
+
+			return;
+		}
 
 		if (!visitor.m_result.m_match || !visitor.m_result.m_extraData)
 			return;
@@ -304,7 +769,12 @@ namespace EEF
 			return;
 
 		if (!HasItemAbility(actor, visitor.m_result.m_form, enchantment))
+		{
+			TraceScope ts(TraceProfiler::Span::kUpdateArmorAbility, actor);
+
 			actor->UpdateArmorAbility(visitor.m_result.m_form, visitor.m_result.m_extraData);
+			Metrics::Inc(Metrics::Counter::kFixesApplied);
+		}
 	}
 
 	auto EEFEventHandler::ReceiveEvent(const TESEquipEvent* a_evn, BSTEventSource<TESEquipEvent>*)
@@ -312,6 +782,12 @@ namespace EEF
 	{
 		if (a_evn)
 		{
+			MetricsScope ms(Metrics::Probe::kEquipEvent);
+			auto actor = a_evn->actor ? a_evn->actor->As<Actor>() : nullptr;
+
+			SlowOpScope sos(SlowOpLog::Op::kEquipEvent, actor);
+			TraceScope ts(TraceProfiler::Span::kEquipEvent, actor);
+
 			HandleEvent(a_evn);
 		}
 
@@ -321,11 +797,26 @@ namespace EEF
 	auto EEFEventHandler::ReceiveEvent(const TESObjectLoadedEvent* evn, BSTEventSource<TESObjectLoadedEvent>*)
 		-> EventResult
 	{
-		if (evn && evn->loaded)
+		if (!evn)
+			return EventResult::kContinue;
+
+		if (!evn->loaded)
 		{
+			if (s_actorCacheEnabled.load(std::memory_order_relaxed))
+				s_actorCache.Erase(evn->formId);
+		}
+		else
+		{
+			HookCostScope hcs(HookID::kOnActorLoad);
+
+			if (!HookControl::IsEnabled(HookID::kOnActorLoad))
+				return EventResult::kContinue;
+
+			MetricsScope ms(Metrics::Probe::kLoadEvent);
+
 			if (auto actor = evn->formId.As<Actor>())
 			{
-				ScheduleEFT(actor);
+				ScheduleLoadedActor(actor);
 			}
 		}
 
@@ -337,11 +828,241 @@ namespace EEF
 	{
 		if (evn && evn->reference)
 		{
+			HookCostScope hcs(HookID::kOnActorLoad);
+
+			if (!HookControl::IsEnabled(HookID::kOnActorLoad))
+				return EventResult::kContinue;
+
+			MetricsScope ms(Metrics::Probe::kInitScriptEvent);
+
 			if (evn->reference->loadedState &&
 			    evn->reference->formType == Actor::kTypeID &&
 			    !evn->reference->IsDead())
 			{
-				ScheduleEFT(evn->reference);
+				ScheduleLoadedActor(static_cast<Actor*>(evn->reference));
+			}
+		}
+
+		return EventResult::kContinue;
+	}
+
+	static bool BuildActorState(Actor* a_actor, ActorState& a_out)
+	{
+		if (!IsREFRValid(a_actor))
+			return false;
+
+		auto containerChanges = a_actor->extraData.Get<ExtraContainerChanges>();
+		if (!containerChanges ||
+		    !containerChanges->data ||
+		    !containerChanges->data->objList)
+		{
+			return false;
+		}
+
+		EquippedEnchantedItemCollector collector;
+		containerChanges->data->objList->Visit(collector);
+
+		ActiveItemEffects effects;
+		effects.Collect(a_actor);
+
+		a_out.m_items.reserve(collector.m_results.size());
+
+		for (auto& e : collector.m_results)
+		{
+			a_out.m_items.emplace_back(WornEnchantment{
+				e.m_form,
+				e.m_enchantment,
+				effects.Contains(e.m_form, e.m_enchantment) });
+		}
+
+		return true;
+	}
+
+	class QueryInterface :
+		public IQueryInterface
+	{
+	public:
+		static QueryInterface* GetSingleton()
+		{
+			static QueryInterface iface;
+			return &iface;
+		}
+
+		virtual std::uint32_t GetVersion() const override
+		{
+			return VERSION;
+		}
+
+		virtual bool VisitWornEnchantments(
+			Actor* a_actor,
+			WornEnchantmentVisitor_t a_func,
+			void* a_user) override
+		{
+			if (!a_actor || !a_func)
+				return false;
+
+			// no lock is held while a_func runs, it may call back into us or dispatch messages
+			WornItemsSnapshot items;
+
+			bool hit = s_actorCache.Get(a_actor->formID, items);
+
+			Metrics::CacheResult(Metrics::Cache::kActorState, hit);
+
+			if (hit)
+			{
+				if (ShadowVerifier::ShouldSample() && IsMainThread())
+				{
+					ShadowVerify("actor cache", a_actor, items.get());
+				}
+			}
+			else
+			{
+				// inventories are only walked on the main thread
+				if (!IsMainThread())
+					return false;
+
+				ActorState state;
+
+				if (!BuildActorState(a_actor, state))
+					return false;
+
+				items = s_actorCache.Update(a_actor->formID, std::move(state));
+			}
+
+			a_func(
+				items->data(),
+				static_cast<std::uint32_t>(items->size()),
+				a_user);
+
+			return true;
+		}
+	};
+
+	static void ReloadHookConfig(const char* a_source)
+	{
+		INIConfReader confReader(PLUGIN_INI_FILE_NOEXT);
+
+		if (!confReader.is_loaded())
+		{
+			gLog.Warning("%s: unable to load the configuration file", a_source);
+			return;
+		}
+
+		HookControl::Set(
+			HookID::kRedirectDispel,
+			confReader.GetBoolValue("EEF", "RedirectDispelWornItemEnchantsVisitor", true),
+			a_source);
+
+		HookControl::Set(
+			HookID::kScriptEquipEventFix,
+			confReader.GetBoolValue("EEF", "ScriptEquipEventFix", false),
+			a_source);
+
+		HookControl::Set(
+			HookID::kOnActorLoad,
+			confReader.GetBoolValue("EEF", "OnActorLoad", true),
+			a_source);
+	}
+
+	static void APIMessageHandler(SKSEMessagingInterface::Message* a_message)
+	{
+		switch (a_message->type)
+		{
+		case kMessage_GetQueryInterface:
+			{
+				if (!a_message->data ||
+				    a_message->dataLen < sizeof(InterfaceRequest))
+				{
+					break;
+				}
+
+				auto request = static_cast<InterfaceRequest*>(a_message->data);
+
+				if (request->version == IQueryInterface::VERSION)
+				{
+					request->result = static_cast<IQueryInterface*>(QueryInterface::GetSingleton());
+					s_actorCacheEnabled.store(true, std::memory_order_relaxed);
+				}
+				else
+				{
+					request->result = nullptr;
+				}
+			}
+			break;
+		case kMessage_RevalidateActors:
+			{
+				if (!a_message->data ||
+				    a_message->dataLen < sizeof(RevalidateRequest))
+				{
+					break;
+				}
+
+				auto request = static_cast<const RevalidateRequest*>(a_message->data);
+
+				if (!request->handles && request->count)
+				{
+					break;
+				}
+
+				if (s_eft.AddBatch(request->handles, request->count, request->callback, request->user))
+				{
+					ISKSE::GetSingleton().GetInterface<SKSETaskInterface>()->AddTask(&s_eft);
+				}
+			}
+			break;
+		case kMessage_SetHookState:
+			{
+				if (!a_message->data ||
+				    a_message->dataLen < sizeof(HookStateRequest))
+				{
+					break;
+				}
+
+				auto request = static_cast<HookStateRequest*>(a_message->data);
+
+				request->result = HookControl::Set(request->hook, request->enabled, "message");
+			}
+			break;
+		case kMessage_ReloadConfig:
+
+			if (HookControl::IsToggleAllowed())
+				ReloadHookConfig("reload message");
+
+			break;
+		}
+	}
+
+	auto EEFEventHandler::ReceiveEvent(const TESCellAttachDetachEvent* evn, BSTEventSource<TESCellAttachDetachEvent>*)
+		-> EventResult
+	{
+		if (!evn || !evn->reference || evn->reference->formType != Actor::kTypeID)
+			return EventResult::kContinue;
+
+		if (evn->attached)
+		{
+			HookCostScope hcs(HookID::kOnActorLoad);
+
+			if (!HookControl::IsEnabled(HookID::kOnActorLoad))
+				return EventResult::kContinue;
+
+			MetricsScope ms(Metrics::Probe::kCellEvent);
+
+			if (!evn->reference->IsDead())
+			{
+				ScheduleLoadedActor(static_cast<Actor*>(evn->reference));
+			}
+		}
+		else
+		{
+			MetricsScope ms(Metrics::Probe::kCellEvent);
+
+			if (s_actorCacheEnabled.load(std::memory_order_relaxed))
+				s_actorCache.Erase(evn->reference->formID);
+
+			// cell detached before the batch or the queue got to it
+			if (s_cellScheduler.OnDetach(evn->reference))
+			{
+				Metrics::Inc(Metrics::Counter::kScheduleCancelled);
 			}
 		}
 
@@ -354,12 +1075,13 @@ namespace EEF
 		{
 		case SKSEMessagingInterface::kMessage_InputLoaded:
 			{
-				if (s_validateOnLoad)
-				{
-					auto handler = EEFEventHandler::GetSingleton();
+				auto handler = EEFEventHandler::GetSingleton();
 
+				// also sunk without OnActorLoad, unload events evict the actor state cache
+				if (s_validateOnLoad && s_cellAwareScheduling)
+					ScriptEventSourceHolder::GetSingleton()->AddEventSink<TESCellAttachDetachEvent>(handler);
+				else
 					ScriptEventSourceHolder::GetSingleton()->AddEventSink<TESObjectLoadedEvent>(handler);
-				}
 			}
 			break;
 		case SKSEMessagingInterface::kMessage_DataLoaded:
@@ -370,10 +1092,20 @@ namespace EEF
 				edl->AddEventSink<TESEquipEvent>(handler);
 				if (s_validateOnLoad)
 					edl->AddEventSink<TESInitScriptEvent>(handler);
+
+				s_actorFilter.Build();
+
+#ifdef _DEBUG
+				if (s_benchmark.producers)
+					SchedulerBenchmark::Start(s_benchmark);
+#endif
 			}
 			break;
 		case SKSEMessagingInterface::kMessage_PreLoadGame:
 
+			if (HookControl::IsToggleAllowed())
+				ReloadHookConfig("INI on load");
+
 			if (s_doRecalcWeight)
 				s_triggeredWeightRecalc = false;
 
@@ -384,6 +1116,11 @@ namespace EEF
 			if (s_validateOnLoad || s_validateOnEffectRemoved)
 				ClearEFTData();
 
+			TraceProfiler::BeginCapture();
+
+			if (s_debounceAddRemoveDispel)
+				s_dispelTask.Clear();
+
 			break;
 
 		case SKSEMessagingInterface::kMessage_PostLoadGame:
@@ -391,6 +1128,21 @@ namespace EEF
 			if (s_doRecalcWeight)
 				ISKSE::GetSingleton().GetInterface<SKSETaskInterface>()->AddTask(&s_wrct);
 
+			if (s_postLoadWarmup)
+			{
+				// move pending cell batches into the queue so the workers see them
+				if (s_cellAwareScheduling)
+					s_cellScheduler.Run();
+
+				WarmupQueuedActors();
+			}
+
+			if (s_runtimeLog)
+			{
+				LogMemoryUsage("PostLoadGame");
+				ShadowVerifier::LogSummary();
+			}
+
 			break;
 		}
 	}
@@ -433,6 +1185,8 @@ namespace EEF
 
 		ScheduleEFT(a_actor);
 
+		TraceScope ts(TraceProfiler::Span::kDispel, a_actor);
+
 		auto effects = a_actor->GetActiveEffectList();
 		if (!effects)
 			return true;
@@ -449,11 +1203,16 @@ namespace EEF
 			    !(effect->flags.test(ActiveEffect::Flag::kDispelled)))
 			{
 				FindEquippedArmorItemVisitor visitor(effect->source);
-				containerChanges->data->objList->Visit(visitor);
+
+				{
+					TraceScope tsv(TraceProfiler::Span::kInventoryVisit, a_actor);
+					containerChanges->data->objList->Visit(visitor);
+				}
 
 				if (!visitor.m_result.m_match)
 				{
 					effect->Dispel(false);
+					Metrics::Inc(Metrics::Counter::kEffectsDispelled);
 				}
 			}
 		}
@@ -463,6 +1222,17 @@ namespace EEF
 
 	static void Inventory_DispelWornItemEnchantsVisitor_inv_Hook(Character* a_actor)
 	{
+		HookCostScope hcs(HookID::kRedirectDispel);
+
+		if (!HookControl::IsEnabled(HookID::kRedirectDispel))
+		{
+			inv_DispelWornItemEnchantsVisitor_o(a_actor);
+			return;
+		}
+
+		MetricsScope ms(Metrics::Probe::kDispelInventory);
+		SlowOpScope sos(SlowOpLog::Op::kDispelInventory, a_actor);
+
 		if (!Inventory_DispelWornItemEnchantsVisitor_Impl(a_actor))
 		{
 			inv_DispelWornItemEnchantsVisitor_o(a_actor);
@@ -471,12 +1241,93 @@ namespace EEF
 
 	static void Inventory_DispelWornItemEnchantsVisitor_addrem_Hook(Character* a_actor)
 	{
+		HookCostScope hcs(HookID::kRedirectDispel);
+
+		if (!HookControl::IsEnabled(HookID::kRedirectDispel))
+		{
+			addrem_DispelWornItemEnchantsVisitor_o(a_actor);
+			return;
+		}
+
+		if (s_debounceAddRemoveDispel && IsREFRValid(a_actor))
+		{
+			auto handle = a_actor->GetHandle();
+			if (handle && handle.IsValid())
+			{
+				bool submit;
+
+				if (!s_dispelTask.Add(handle, submit))
+				{
+					// already queued for this frame
+					Metrics::Inc(Metrics::Counter::kDispelsCoalesced);
+				}
+
+				if (submit)
+				{
+					ISKSE::GetSingleton().GetInterface<SKSETaskInterface>()->AddTask(&s_dispelTask);
+				}
+
+				return;
+			}
+		}
+
+		MetricsScope ms(Metrics::Probe::kDispelAddRemove);
+		SlowOpScope sos(SlowOpLog::Op::kDispelAddRemove, a_actor);
+
 		if (!Inventory_DispelWornItemEnchantsVisitor_Impl(a_actor))
 		{
 			addrem_DispelWornItemEnchantsVisitor_o(a_actor);
 		}
 	}
 
+	bool DeferredDispelTask::Add(Game::ObjectRefHandle a_handle, bool& a_submit)
+	{
+		stl::scoped_lock lock(m_lock);
+
+		// a non-empty set means a Run is already pending
+		a_submit = m_data.empty();
+
+		return m_data.emplace(a_handle).second;
+	}
+
+	void DeferredDispelTask::Clear()
+	{
+		stl::scoped_lock lock(m_lock);
+		m_data.clear();
+	}
+
+	void DeferredDispelTask::Run()
+	{
+		decltype(m_data) data;
+
+		{
+			stl::scoped_lock lock(m_lock);
+			data.swap(m_data);
+		}
+
+		for (const auto& e : data)
+		{
+			NiPointer<TESObjectREFR> ref;
+			if (!e.Lookup(ref))
+				continue;
+
+			auto actor = ref->As<Actor>();
+			if (!actor)
+				continue;
+
+			// every actor reference is a Character
+			auto character = static_cast<Character*>(actor);
+
+			MetricsScope ms(Metrics::Probe::kDispelAddRemove);
+			SlowOpScope sos(SlowOpLog::Op::kDispelAddRemove, actor);
+
+			if (!Inventory_DispelWornItemEnchantsVisitor_Impl(character))
+			{
+				addrem_DispelWornItemEnchantsVisitor_o(character);
+			}
+		}
+	}
+
 	static auto updateArmorAbility1_addr = IAL::Addr(36976, 38001, 0x3BB, 0x36D);
 
 	updateArmorAbility_t updateArmorAbility_o;
@@ -508,13 +1359,21 @@ namespace EEF
 
 	static void UpdateArmorAbility_Hook1(Actor* a_actor, TESForm* a_form, BaseExtraList* a_extraData)
 	{
-		if (a_actor && a_form)
+		HookCostScope hcs(HookID::kRedirectDispel);
+		MetricsScope ms(Metrics::Probe::kUpdateArmorAbility);
+		TraceScope ts(TraceProfiler::Span::kUpdateArmorAbility, a_actor);
+
+		if (a_actor && a_form && HookControl::IsEnabled(HookID::kRedirectDispel))
 		{
 			if (a_form->formType == TESObjectARMO::kTypeID)
 			{
 				if (auto enchantment = GetEnchantmentWithBase(a_form, a_extraData))
 				{
-					if (HasItemAbility(a_actor, a_form, enchantment))
+					bool skip = HasItemAbility(a_actor, a_form, enchantment);
+
+					Metrics::CacheResult(Metrics::Cache::kUpdateArmorAbilitySkip, skip);
+
+					if (skip)
 					{
 						return;
 					}
@@ -552,7 +1411,12 @@ namespace EEF
 		bool a_showMsg,
 		void* a_unk)
 	{
-		if (!a_extraList && a_actor && a_form && a_count > 0 && a_actor->processManager)
+		HookCostScope hcs(HookID::kScriptEquipEventFix);
+		MetricsScope ms(Metrics::Probe::kEquipItem);
+		SlowOpScope sos(SlowOpLog::Op::kEquipItem, a_actor);
+
+		if (!a_extraList && a_actor && a_form && a_count > 0 && a_actor->processManager &&
+		    HookControl::IsEnabled(HookID::kScriptEquipEventFix))
 		{
 			if (a_form != a_actor->processManager->equippedObject[0] &&
 			    a_form != a_actor->processManager->equippedObject[1])
@@ -563,7 +1427,11 @@ namespace EEF
 				    containerChanges->data->objList)
 				{
 					EquipItemHookVisitor v(a_form);
-					containerChanges->data->objList->Visit(v);
+
+					{
+						TraceScope ts(TraceProfiler::Span::kInventoryVisit, a_actor);
+						containerChanges->data->objList->Visit(v);
+					}
 
 					if (v.m_match && !v.m_result.m_equipped)
 					{
@@ -595,10 +1463,43 @@ namespace EEF
 			gLog.Warning("Unable to load the configuration file, using defaults");
 		}
 
+		// plugin load runs on the main thread
+		s_mainThreadId = ::GetCurrentThreadId();
+
 		s_validateOnLoad = confReader.GetBoolValue("EEF", "OnActorLoad", true);
 		s_doRecalcWeight = confReader.GetBoolValue("EEF", "RecalcPlayerInventoryWeightOnLoad", false);
+		bool actorPreFilter = confReader.GetBoolValue("EEF", "ActorPreFilter", false);
+		s_dispelOnUnequip = confReader.GetBoolValue("EEF", "DispelOnUnequip", false);
+		s_postLoadWarmup = confReader.GetBoolValue("EEF", "PostLoadWarmup", false);
+		s_debounceAddRemoveDispel = confReader.GetBoolValue("EEF", "DebounceAddRemoveDispel", false);
+		s_cellAwareScheduling = confReader.GetBoolValue("EEF", "CellAwareScheduling", false);
 		bool redirectDispelWornItemEnchantsVisitor = confReader.GetBoolValue("EEF", "RedirectDispelWornItemEnchantsVisitor", true);
 		bool equipManagerHook = confReader.GetBoolValue("EEF", "ScriptEquipEventFix", false);
+		bool allowHookToggle = confReader.GetBoolValue("EEF", "AllowRuntimeHookToggle", false);
+		auto metricsInterval = confReader.GetLongValue("EEF", "MetricsSnapshotInterval", 0);
+		auto memoryBudget = confReader.GetLongValue("EEF", "MemoryBudgetKB", -1);
+		auto slowOpThreshold = confReader.GetLongValue("EEF", "SlowOperationThresholdUs", 0);
+		auto shadowSampleRate = confReader.GetLongValue("EEF", "ShadowVerifySampleRate", 0);
+		auto traceCaptureMs = confReader.GetLongValue("EEF", "TraceCaptureMs", 0);
+
+		const bool hookState[] = {
+			redirectDispelWornItemEnchantsVisitor,
+			equipManagerHook,
+			s_validateOnLoad
+		};
+
+		HookControl::Initialize(allowHookToggle, hookState);
+
+		if (allowHookToggle)
+		{
+			// everything gets installed, the INI only sets the initial dispatch state
+			redirectDispelWornItemEnchantsVisitor = true;
+			equipManagerHook = true;
+			s_validateOnLoad = true;
+			s_runtimeLog = true;
+
+			gLog.Message("Runtime hook toggle ON");
+		}
 
 		auto& branchTrampoline = ISKSE::GetBranchTrampoline();
 
@@ -632,6 +1533,9 @@ namespace EEF
 			}
 
 			gLog.Message("RedirectDispelWornItemEnchantsVisitor ON");
+
+			if (s_debounceAddRemoveDispel)
+				gLog.Message("DebounceAddRemoveDispel ON");
 		}
 
 		if (equipManagerHook)
@@ -674,8 +1578,96 @@ namespace EEF
 		}
 
 		if (s_validateOnLoad)
+		{
 			gLog.Message("OnActorLoad ON");
 
+			if (s_cellAwareScheduling)
+				gLog.Message("CellAwareScheduling ON");
+		}
+
+		if (s_dispelOnUnequip)
+			gLog.Message("DispelOnUnequip ON");
+
+		if (s_postLoadWarmup)
+			gLog.Message("PostLoadWarmup ON");
+
+		if (actorPreFilter)
+		{
+			s_actorFilter.Configure(
+				confReader.GetValue("EEF", "ExcludeRaces", ""),
+				confReader.GetValue("EEF", "ExcludeKeywords", ""));
+
+			// filter statistics are reported at kMessage_DataLoaded
+			s_runtimeLog = true;
+
+			gLog.Message("ActorPreFilter ON");
+		}
+
+		if (metricsInterval > 0)
+		{
+			auto interval = static_cast<std::uint32_t>(std::max(metricsInterval, 250l));
+
+			Metrics::Start(interval);
+
+			gLog.Message("Metrics snapshot every %u ms", interval);
+		}
+
+		if (memoryBudget < 0)
+		{
+			s_actorCache.SetBudget(static_cast<std::size_t>(DEFAULT_MEMORY_BUDGET_KB) * 1024);
+		}
+		else
+		{
+			// 0 lifts the limit
+			s_actorCache.SetBudget(static_cast<std::size_t>(memoryBudget) * 1024);
+			s_runtimeLog = true;
+
+			gLog.Message("Memory budget: %ld KB", memoryBudget);
+		}
+
+		if (slowOpThreshold > 0)
+		{
+			SlowOpLog::Start(static_cast<std::uint32_t>(slowOpThreshold));
+			s_runtimeLog = true;
+
+			gLog.Message("Slow operation threshold: %ld us", slowOpThreshold);
+		}
+
+		if (shadowSampleRate > 0)
+		{
+			ShadowVerifier::Initialize(static_cast<std::uint32_t>(shadowSampleRate));
+			s_runtimeLog = true;
+
+			gLog.Message("Shadow verification: 1 in %ld calls", shadowSampleRate);
+		}
+
+		if (traceCaptureMs > 0)
+		{
+			TraceProfiler::Initialize(static_cast<std::uint32_t>(traceCaptureMs));
+			s_runtimeLog = true;
+
+			gLog.Message("Trace capture: %ld ms after each load", traceCaptureMs);
+		}
+
+#ifdef _DEBUG
+		auto benchmarkThreads = confReader.GetLongValue("EEF", "SchedulerBenchmarkThreads", 0);
+
+		if (benchmarkThreads > 0)
+		{
+			// one core is left for the consumer
+			auto maxThreads = static_cast<long>(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+
+			s_benchmark.producers = static_cast<std::uint32_t>(std::min(benchmarkThreads, maxThreads));
+			s_benchmark.durationMs = static_cast<std::uint32_t>(std::max(confReader.GetLongValue("EEF", "SchedulerBenchmarkDurationMs", 5000), 100l));
+			s_benchmark.handleSpace = static_cast<std::uint32_t>(std::max(confReader.GetLongValue("EEF", "SchedulerBenchmarkHandles", 4096), 1l));
+			s_benchmark.frameMs = static_cast<std::uint32_t>(std::max(confReader.GetLongValue("EEF", "SchedulerBenchmarkFrameMs", 16), 1l));
+			s_benchmark.processNs = static_cast<std::uint32_t>(std::max(confReader.GetLongValue("EEF", "SchedulerBenchmarkProcessNs", 2000), 0l));
+
+			// results are logged at kMessage_DataLoaded
+			s_runtimeLog = true;
+		}
+#endif
+
 		auto& si = ISKSE::GetSingleton();
 
 		if (!si.GetInterface<SKSEMessagingInterface>()->RegisterListener(
@@ -686,6 +1678,19 @@ namespace EEF
 			gLog.FatalError("Couldn't add message listener");
 		}
 
+		if (!si.GetInterface<SKSEMessagingInterface>()->RegisterListener(
+				si.GetPluginHandle(),
+				nullptr,
+				APIMessageHandler))
+		{
+			gLog.Error("Couldn't add API message listener");
+		}
+
 		return true;
 	}
+
+	bool NeedsRuntimeLog()
+	{
+		return s_runtimeLog;
+	}
 }
\ No newline at end of file
@@ -17,12 +17,152 @@ namespace EEF
 
 		static void ProcessActor(Actor* a_actor);
 
+		// approximate heap footprint of m_data, caller holds m_lock
+		[[nodiscard]] std::size_t GetUsage() const noexcept;
+
 		inline bool Add(Game::ObjectRefHandle a_handle)
 		{
 			stl::scoped_lock lock(m_lock);
-			return m_data.emplace(a_handle).second;
+#ifdef _DEBUG
+			HoldTimer ht(m_holdTimings ? std::addressof(m_holdTimings->add) : nullptr);
+#endif
+			auto result = m_data.emplace(a_handle).second;
+			ReportQueueDepth();
+			return result;
+		}
+
+		// returns true if the task must be submitted
+		bool AddBatch(
+			const std::uint32_t* a_handles,
+			std::uint32_t a_count,
+			RevalidateCallback_t a_callback,
+			void* a_user);
+
+		bool AddBatch(const std::vector<Game::ObjectRefHandle>& a_handles);
+
+		// removes a_handle from the queue unless it's being drained
+		inline bool Cancel(Game::ObjectRefHandle a_handle)
+		{
+			stl::scoped_lock lock(m_lock);
+
+			if (m_running)
+			{
+				return false;
+			}
+
+			auto result = m_data.erase(a_handle) != 0;
+			ReportQueueDepth();
+			return result;
+		}
+
+		// the critical section Run drains the queue in, a_func gets each queued handle
+		template <class Tf>
+		void Drain(Tf a_func)
+		{
+			stl::scoped_lock lock(m_lock);
+			DrainImpl(a_func);
 		}
 
+#ifdef _DEBUG
+		// lock hold times for the scheduler benchmark, a task with these set stays out of Metrics
+		struct HoldTimings
+		{
+			LatencyHistogram add;
+			LatencyHistogram drain;
+		};
+
+		HoldTimings* m_holdTimings{ nullptr };
+#endif
+
+		stl::critical_section m_lock;
+		std::unordered_set<Game::ObjectRefHandle> m_data;
+		std::vector<std::pair<RevalidateCallback_t, void*>> m_callbacks;
+
+	private:
+#ifdef _DEBUG
+		class HoldTimer
+		{
+		public:
+			SKMP_FORCEINLINE HoldTimer(LatencyHistogram* a_out) noexcept :
+				m_out(a_out)
+			{
+				if (m_out)
+				{
+					m_start = std::chrono::steady_clock::now();
+				}
+			}
+
+			SKMP_FORCEINLINE ~HoldTimer() noexcept
+			{
+				if (m_out)
+				{
+					m_out->Add(static_cast<std::uint64_t>(
+						std::chrono::duration_cast<std::chrono::nanoseconds>(
+							std::chrono::steady_clock::now() - m_start)
+							.count()));
+				}
+			}
+
+			HoldTimer(const HoldTimer&) = delete;
+			HoldTimer& operator=(const HoldTimer&) = delete;
+
+		private:
+			LatencyHistogram* m_out;
+			std::chrono::steady_clock::time_point m_start;
+		};
+#endif
+
+		void RunImpl();
+
+		// caller holds m_lock
+		SKMP_FORCEINLINE void ReportQueueDepth() const noexcept
+		{
+#ifdef _DEBUG
+			if (m_holdTimings)
+			{
+				return;
+			}
+#endif
+			Metrics::SetQueueDepth(m_data.size());
+		}
+
+		// caller holds m_lock
+		template <class Tf>
+		void DrainImpl(Tf&& a_func)
+		{
+#ifdef _DEBUG
+			HoldTimer ht(m_holdTimings ? std::addressof(m_holdTimings->drain) : nullptr);
+#endif
+			m_running = true;
+
+			for (const auto& e : m_data)
+			{
+				a_func(e);
+			}
+
+			m_running = false;
+
+			m_data.clear();
+
+			ReportQueueDepth();
+		}
+
+		bool m_running{ false };
+	};
+
+	// Coalesces add/remove dispel passes (e.g. "Take All") into a single pass per actor
+	// on the next task drain.
+	class DeferredDispelTask :
+		public TaskDelegate
+	{
+	public:
+		virtual void Run() override;
+		virtual void Dispose() override{};
+
+		// returns false if a_handle was already queued, a_submit is set if the task must be submitted
+		bool Add(Game::ObjectRefHandle a_handle, bool& a_submit);
+		void Clear();
+
 		stl::critical_section m_lock;
 		std::unordered_set<Game::ObjectRefHandle> m_data;
 	};
@@ -38,13 +178,15 @@ namespace EEF
 	class EEFEventHandler :
 		public BSTEventSink<TESEquipEvent>,
 		public BSTEventSink<TESObjectLoadedEvent>,
-		public BSTEventSink<TESInitScriptEvent>
+		public BSTEventSink<TESInitScriptEvent>,
+		public BSTEventSink<TESCellAttachDetachEvent>
 
 	{
 	protected:
 		virtual EventResult ReceiveEvent(const TESEquipEvent* evn, BSTEventSource<TESEquipEvent>* dispatcher) override;
 		virtual EventResult ReceiveEvent(const TESObjectLoadedEvent* evn, BSTEventSource<TESObjectLoadedEvent>* dispatcher) override;
 		virtual EventResult ReceiveEvent(const TESInitScriptEvent* evn, BSTEventSource<TESInitScriptEvent>* dispatcher) override;
+		virtual EventResult ReceiveEvent(const TESCellAttachDetachEvent* evn, BSTEventSource<TESCellAttachDetachEvent>* dispatcher) override;
 
 	public:
 		static EEFEventHandler* GetSingleton()
@@ -73,13 +215,23 @@ namespace EEF
 		EnchantmentItem* m_enchantment;
 	};
 
-	struct EquippedEnchantedArmorItemCollector
+	// worn ARMO, WEAP and AMMO carrying an ExtraEnchantment
+	struct EquippedEnchantedItemCollector
 	{
 		bool Accept(InventoryEntryData* a_entryData);
 
 		std::vector<ItemEntry> m_results;
 	};
 
+	// armor-sourced active effects gathered in a single pass over the effect list
+	struct ActiveItemEffects
+	{
+		void Collect(Actor* a_actor);
+		[[nodiscard]] bool Contains(TESForm* a_form, EnchantmentItem* a_enchantment) const;
+
+		std::vector<std::pair<TESForm*, MagicItem*>> m_data;
+	};
+
 	class MatchForm :
 		public FormMatcher
 	{
@@ -134,4 +286,5 @@ namespace EEF
 	};
 
 	bool Initialize();
+	bool NeedsRuntimeLog();
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+// Public messaging interface. Self-contained so other plugins can copy it as-is.
+//
+// Request the interface from kMessage_PostLoad onwards:
+//
+//   EEF::InterfaceRequest req{ EEF::IQueryInterface::VERSION, nullptr };
+//   messaging->Dispatch(handle, EEF::kMessage_GetQueryInterface, &req, sizeof(req), "EquipEnchantmentFix");
+//
+// req.result stays nullptr if the plugin isn't loaded or doesn't support the requested version.
+//
+// To have a set of actors revalidated, e.g. after changing their outfits:
+//
+//   EEF::RevalidateRequest req{ handles, count, OnDone, userData };
+//   messaging->Dispatch(handle, EEF::kMessage_RevalidateActors, &req, sizeof(req), "EquipEnchantmentFix");
+//
+// The handle array is copied before Dispatch returns. If a new game or a load starts before
+// the batch is processed, the batch is abandoned and the callback is still invoked once.
+//
+// With AllowRuntimeHookToggle=true in the plugin's INI, hooks can be switched at runtime:
+//
+//   EEF::HookStateRequest req{ EEF::HookID::kOnActorLoad, false };
+//   messaging->Dispatch(handle, EEF::kMessage_SetHookState, &req, sizeof(req), "EquipEnchantmentFix");
+//
+// kMessage_ReloadConfig (no data) re-applies the hook switches from the INI.
+//
+// Threading:
+//
+//   - Messages may be dispatched from any thread.
+//   - Revalidation callbacks are invoked on the main thread.
+//   - VisitWornEnchantments may be called from any thread, but an actor without a cached
+//     result is only resolved on the main thread; elsewhere the call returns false.
+//   - No plugin lock is held while a visitor or callback runs, so they may call back into
+//     the interface or dispatch messages.
+
+class Actor;
+class TESForm;
+class EnchantmentItem;
+
+namespace EEF
+{
+	enum : std::uint32_t
+	{
+		kMessage_GetQueryInterface = 0xEEF00001,
+		kMessage_RevalidateActors = 0xEEF00002,
+		kMessage_SetHookState = 0xEEF00003,
+		kMessage_ReloadConfig = 0xEEF00004
+	};
+
+	enum class HookID : std::uint32_t
+	{
+		kRedirectDispel,  // DispelWornItemEnchantsVisitor redirect + UpdateArmorAbility
+		kScriptEquipEventFix,
+		kOnActorLoad,
+
+		kMax
+	};
+
+	struct HookStateRequest
+	{
+		HookID hook;
+		bool enabled;
+		bool result;  // set to true if the switch was accepted
+	};
+
+	struct InterfaceRequest
+	{
+		std::uint32_t version;
+		void* result;
+	};
+
+	// form is a worn TESObjectARMO, TESObjectWEAP or TESAmmo
+	struct WornEnchantment
+	{
+		TESForm* form;
+		EnchantmentItem* enchantment;
+		bool active;  // armor only: its ability was present when last validated, always false for weapons and ammo
+	};
+
+	// a_items is only valid for the duration of the call
+	using WornEnchantmentVisitor_t = void (*)(
+		const WornEnchantment* a_items,
+		std::uint32_t a_count,
+		void* a_user);
+
+	// invoked on the main thread once every actor in the batch has been processed
+	using RevalidateCallback_t = void (*)(void* a_user);
+
+	struct RevalidateRequest
+	{
+		const std::uint32_t* handles;  // ObjectRefHandle
+		std::uint32_t count;
+		RevalidateCallback_t callback;  // optional
+		void* user;
+	};
+
+	class IQueryInterface
+	{
+	public:
+		static constexpr std::uint32_t VERSION = 1;
+
+		[[nodiscard]] virtual std::uint32_t GetVersion() const = 0;
+
+		// Invokes a_func once, on the calling thread, with the worn enchanted items of a_actor,
+		// reusing the result of the last validation when available. Returns false if a_actor
+		// isn't valid or has no cached result and the caller isn't the main thread.
+		virtual bool VisitWornEnchantments(
+			Actor* a_actor,
+			WornEnchantmentVisitor_t a_func,
+			void* a_user) = 0;
+	};
+}
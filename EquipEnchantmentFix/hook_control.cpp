@@ -0,0 +1,65 @@
+#include "pch.h"
+
+namespace EEF
+{
+	static constexpr const char* s_hookNames[] = {
+		"RedirectDispelWornItemEnchantsVisitor",
+		"ScriptEquipEventFix",
+		"OnActorLoad"
+	};
+
+	static_assert(std::size(s_hookNames) == std::to_underlying(HookID::kMax));
+
+	void HookControl::Initialize(bool a_allowToggle, const bool (&a_initial)[std::to_underlying(HookID::kMax)])
+	{
+		m_allowToggle = a_allowToggle;
+
+		auto now = std::chrono::steady_clock::now();
+
+		for (std::uint32_t i = 0; i < std::to_underlying(HookID::kMax); i++)
+		{
+			m_hooks[i].enabled.store(a_initial[i], std::memory_order_relaxed);
+			m_hooks[i].since = now;
+		}
+	}
+
+	bool HookControl::Set(HookID a_id, bool a_enabled, const char* a_source)
+	{
+		if (!m_allowToggle ||
+		    a_id >= HookID::kMax)
+		{
+			return false;
+		}
+
+		std::lock_guard lock(m_lock);
+
+		auto& e = m_hooks[std::to_underlying(a_id)];
+
+		bool previous = e.enabled.exchange(a_enabled, std::memory_order_relaxed);
+		if (previous == a_enabled)
+		{
+			return true;
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		auto period = std::chrono::duration<double>(now - e.since).count();
+		e.since = now;
+
+		auto calls = e.calls.exchange(0, std::memory_order_relaxed);
+		auto time = e.time.exchange(0, std::memory_order_relaxed);
+
+		gLog.Message(
+			"%s: %s -> %s (%s). While %s: %llu calls over %.1f s, %.3f ms total, %.3f us/call",
+			s_hookNames[std::to_underlying(a_id)],
+			previous ? "ON" : "OFF",
+			a_enabled ? "ON" : "OFF",
+			a_source,
+			previous ? "on" : "off",
+			calls,
+			period,
+			static_cast<double>(time) / 1000000.0,
+			calls ? static_cast<double>(time) / static_cast<double>(calls) / 1000.0 : 0.0);
+
+		return true;
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+namespace EEF
+{
+	// Runtime dispatch switches for the installed hooks. A bypassed hook forwards straight
+	// to the original code. Per-hook call counts and time are kept so each switch can
+	// report what the hook cost while it was on or off.
+	class HookControl
+	{
+	public:
+		static void Initialize(bool a_allowToggle, const bool (&a_initial)[std::to_underlying(HookID::kMax)]);
+
+		[[nodiscard]] SKMP_FORCEINLINE static bool IsEnabled(HookID a_id) noexcept
+		{
+			return m_hooks[std::to_underlying(a_id)].enabled.load(std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] SKMP_FORCEINLINE static bool IsToggleAllowed() noexcept
+		{
+			return m_allowToggle;
+		}
+
+		SKMP_FORCEINLINE static void Record(HookID a_id, std::uint64_t a_ns) noexcept
+		{
+			auto& e = m_hooks[std::to_underlying(a_id)];
+			e.calls.fetch_add(1, std::memory_order_relaxed);
+			e.time.fetch_add(a_ns, std::memory_order_relaxed);
+		}
+
+		static bool Set(HookID a_id, bool a_enabled, const char* a_source);
+
+	private:
+		struct State
+		{
+			std::atomic<bool> enabled{ false };
+			std::atomic<std::uint64_t> calls{ 0 };
+			std::atomic<std::uint64_t> time{ 0 };
+			std::chrono::steady_clock::time_point since;
+		};
+
+		static inline bool m_allowToggle{ false };
+		static inline State m_hooks[std::to_underlying(HookID::kMax)];
+		static inline std::mutex m_lock;
+	};
+
+	class HookCostScope
+	{
+	public:
+		SKMP_FORCEINLINE HookCostScope(HookID a_id) noexcept :
+			m_id(a_id),
+			m_enabled(HookControl::IsToggleAllowed())
+		{
+			if (m_enabled)
+			{
+				m_start = std::chrono::steady_clock::now();
+			}
+		}
+
+		SKMP_FORCEINLINE ~HookCostScope() noexcept
+		{
+			if (m_enabled)
+			{
+				auto e = std::chrono::steady_clock::now() - m_start;
+				HookControl::Record(m_id, std::chrono::duration_cast<std::chrono::nanoseconds>(e).count());
+			}
+		}
+
+		HookCostScope(const HookCostScope&) = delete;
+		HookCostScope& operator=(const HookCostScope&) = delete;
+
+	private:
+		HookID m_id;
+		bool m_enabled;
+		std::chrono::steady_clock::time_point m_start;
+	};
+}
@@ -0,0 +1,221 @@
+#include "pch.h"
+
+namespace EEF
+{
+	static constexpr const char* s_counterNames[] = {
+		"actors_validated",
+		"fixes_applied",
+		"effects_dispelled",
+		"actors_filtered",
+		"shadow_checks",
+		"shadow_mismatches",
+		"dispels_coalesced",
+		"schedule_cancelled"
+	};
+
+	static constexpr const char* s_probeNames[] = {
+		"task_run",
+		"process_actor",
+		"equip_event",
+		"load_event",
+		"init_script_event",
+		"dispel_inventory",
+		"dispel_addrem",
+		"update_armor_ability",
+		"equip_item",
+		"shadow_verify",
+		"cell_event"
+	};
+
+	static constexpr const char* s_cacheNames[] = {
+		"schedule_dedup",
+		"update_armor_ability_skip",
+		"actor_state",
+		"warmup"
+	};
+
+	static_assert(std::size(s_counterNames) == std::to_underlying(Metrics::Counter::kMax));
+	static_assert(std::size(s_probeNames) == std::to_underlying(Metrics::Probe::kMax));
+	static_assert(std::size(s_cacheNames) == std::to_underlying(Metrics::Cache::kMax));
+
+	double LatencyHistogram::Percentile(double a_p) const noexcept
+	{
+		Snapshot snapshot;
+		snapshot.total = 0;
+
+		for (std::uint32_t i = 0; i < NUM_BUCKETS; i++)
+		{
+			snapshot.counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+			snapshot.total += snapshot.counts[i];
+		}
+
+		return snapshot.Percentile(a_p);
+	}
+
+	void LatencyHistogram::Drain(Snapshot& a_out) noexcept
+	{
+		a_out.total = 0;
+
+		for (std::uint32_t i = 0; i < NUM_BUCKETS; i++)
+		{
+			a_out.counts[i] = m_buckets[i].exchange(0, std::memory_order_relaxed);
+			a_out.total += a_out.counts[i];
+		}
+	}
+
+	double LatencyHistogram::Snapshot::Percentile(double a_p) const noexcept
+	{
+		if (!total)
+		{
+			return 0.0;
+		}
+
+		auto rank = static_cast<std::uint64_t>(std::ceil(a_p * static_cast<double>(total)));
+		rank = std::clamp<std::uint64_t>(rank, 1, total);
+
+		std::uint64_t sum = 0;
+
+		for (std::uint32_t i = 0; i < NUM_BUCKETS; i++)
+		{
+			sum += counts[i];
+			if (sum >= rank)
+			{
+				return static_cast<double>(GetBucketUpperBound(i)) / 1000.0;
+			}
+		}
+
+		return static_cast<double>(GetBucketUpperBound(NUM_BUCKETS - 1)) / 1000.0;
+	}
+
+	std::uint64_t LatencyHistogram::GetBucketUpperBound(std::uint32_t a_bucket) noexcept
+	{
+		if (a_bucket < (1u << SUB_BUCKET_BITS))
+		{
+			return a_bucket;
+		}
+
+		auto shift = (a_bucket >> SUB_BUCKET_BITS) - 1;
+		auto sub = a_bucket & ((1u << SUB_BUCKET_BITS) - 1);
+
+		auto lower = static_cast<std::uint64_t>((1u << SUB_BUCKET_BITS) | sub) << shift;
+
+		return lower + ((1ui64 << shift) - 1);
+	}
+
+	void Metrics::Start(std::uint32_t a_intervalMs)
+	{
+		m_enabled = true;
+
+		std::thread(WriterThread, a_intervalMs).detach();
+	}
+
+	void Metrics::WriterThread(std::uint32_t a_intervalMs)
+	{
+		auto path = ReportFile::GetPath(PLUGIN_METRICS_PATH);
+		if (path.empty())
+		{
+			return;
+		}
+
+		std::uint64_t prevCounters[std::to_underlying(Counter::kMax)]{};
+		std::uint64_t probeCalls[std::to_underlying(Probe::kMax)]{};
+
+		LatencyHistogram::Snapshot snapshot;
+
+		auto prevTime = std::chrono::steady_clock::now();
+
+		std::string out;
+
+		for (;;)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(a_intervalMs));
+
+			auto now = std::chrono::steady_clock::now();
+			auto elapsed = std::max(std::chrono::duration<double>(now - prevTime).count(), 0.001);
+			prevTime = now;
+
+			auto wallClock = std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::system_clock::now().time_since_epoch());
+
+			out.clear();
+
+			ReportFile::AppendFormat(
+				out,
+				"{\n\t\"version\": 1,\n\t\"timestamp_ms\": %lld,\n\t\"interval_ms\": %u,\n",
+				static_cast<long long>(wallClock.count()),
+				a_intervalMs);
+
+			ReportFile::AppendFormat(
+				out,
+				"\t\"queue\": { \"depth\": %zu, \"peak\": %zu },\n",
+				m_queueDepth.load(std::memory_order_relaxed),
+				m_queuePeak.exchange(0, std::memory_order_relaxed));
+
+			ReportFile::AppendFormat(
+				out,
+				"\t\"memory\": { \"cache_bytes\": %zu, \"queue_bytes\": %zu },\n",
+				m_cacheBytes.load(std::memory_order_relaxed),
+				m_queueBytes.load(std::memory_order_relaxed));
+
+			out += "\t\"counters\": {\n";
+
+			for (std::uint32_t i = 0; i < std::to_underlying(Counter::kMax); i++)
+			{
+				auto v = m_counters[i].load(std::memory_order_relaxed);
+
+				ReportFile::AppendFormat(
+					out,
+					"\t\t\"%s\": { \"total\": %llu, \"per_sec\": %.2f }%s\n",
+					s_counterNames[i],
+					v,
+					static_cast<double>(v - prevCounters[i]) / elapsed,
+					i + 1 < std::to_underlying(Counter::kMax) ? "," : "");
+
+				prevCounters[i] = v;
+			}
+
+			out += "\t},\n\t\"hooks\": {\n";
+
+			// percentiles cover this interval only, same as the rates
+			for (std::uint32_t i = 0; i < std::to_underlying(Probe::kMax); i++)
+			{
+				m_probes[i].Drain(snapshot);
+
+				probeCalls[i] += snapshot.total;
+
+				ReportFile::AppendFormat(
+					out,
+					"\t\t\"%s\": { \"calls\": %llu, \"calls_per_sec\": %.2f, \"p50_us\": %.3f, \"p99_us\": %.3f }%s\n",
+					s_probeNames[i],
+					probeCalls[i],
+					static_cast<double>(snapshot.total) / elapsed,
+					snapshot.Percentile(0.5),
+					snapshot.Percentile(0.99),
+					i + 1 < std::to_underlying(Probe::kMax) ? "," : "");
+			}
+
+			out += "\t},\n\t\"caches\": {\n";
+
+			// per interval as well
+			for (std::uint32_t i = 0; i < std::to_underlying(Cache::kMax); i++)
+			{
+				auto hits = m_caches[i].hits.exchange(0, std::memory_order_relaxed);
+				auto misses = m_caches[i].misses.exchange(0, std::memory_order_relaxed);
+				auto total = hits + misses;
+
+				ReportFile::AppendFormat(
+					out,
+					"\t\t\"%s\": { \"hits\": %llu, \"misses\": %llu, \"hit_rate\": %.4f }%s\n",
+					s_cacheNames[i],
+					hits,
+					misses,
+					total ? static_cast<double>(hits) / static_cast<double>(total) : 0.0,
+					i + 1 < std::to_underlying(Cache::kMax) ? "," : "");
+			}
+
+			out += "\t}\n}\n";
+
+			ReportFile::Write(path, out);
+		}
+	}
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+namespace EEF
+{
+	class LatencyHistogram
+	{
+		// 4 sub-buckets per power of two, nanosecond resolution
+		static constexpr std::uint32_t SUB_BUCKET_BITS = 2;
+		static constexpr std::uint32_t NUM_BUCKETS = 64 << SUB_BUCKET_BITS;
+
+	public:
+		struct Snapshot
+		{
+			std::uint64_t counts[NUM_BUCKETS];
+			std::uint64_t total;
+
+			[[nodiscard]] double Percentile(double a_p) const noexcept;  // microseconds
+		};
+
+		void Add(std::uint64_t a_ns) noexcept
+		{
+			m_buckets[GetBucket(a_ns)].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] double Percentile(double a_p) const noexcept;  // microseconds
+
+		// moves the current counts into a_out and starts a new window
+		void Drain(Snapshot& a_out) noexcept;
+
+	private:
+		static constexpr std::uint32_t GetBucket(std::uint64_t a_ns) noexcept
+		{
+			if (a_ns < (1ui64 << SUB_BUCKET_BITS))
+			{
+				return static_cast<std::uint32_t>(a_ns);
+			}
+
+			auto msb = static_cast<std::uint32_t>(std::bit_width(a_ns) - 1);
+			auto sub = static_cast<std::uint32_t>(a_ns >> (msb - SUB_BUCKET_BITS)) & ((1u << SUB_BUCKET_BITS) - 1);
+
+			return ((msb - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) | sub;
+		}
+
+		static std::uint64_t GetBucketUpperBound(std::uint32_t a_bucket) noexcept;
+
+		std::atomic<std::uint64_t> m_buckets[NUM_BUCKETS]{};
+	};
+
+	class Metrics
+	{
+	public:
+		enum class Counter : std::uint32_t
+		{
+			kActorsValidated,
+			kFixesApplied,
+			kEffectsDispelled,
+			kActorsFiltered,
+			kShadowChecks,
+			kShadowMismatches,
+			kDispelsCoalesced,
+			kScheduleCancelled,
+
+			kMax
+		};
+
+		// timed call sites, reported as call rate + p50/p99
+		enum class Probe : std::uint32_t
+		{
+			kTaskRun,
+			kProcessActor,
+			kEquipEvent,
+			kLoadEvent,
+			kInitScriptEvent,
+			kDispelInventory,
+			kDispelAddRemove,
+			kUpdateArmorAbility,
+			kEquipItem,
+			kShadowVerify,
+			kCellEvent,
+
+			kMax
+		};
+
+		enum class Cache : std::uint32_t
+		{
+			kScheduleDedup,
+			kUpdateArmorAbilitySkip,
+			kActorState,
+			kWarmup,
+
+			kMax
+		};
+
+		[[nodiscard]] SKMP_FORCEINLINE static bool IsEnabled() noexcept
+		{
+			return m_enabled;
+		}
+
+		SKMP_FORCEINLINE static void Inc(Counter a_id, std::uint64_t a_n = 1) noexcept
+		{
+			if (m_enabled)
+			{
+				m_counters[std::to_underlying(a_id)].fetch_add(a_n, std::memory_order_relaxed);
+			}
+		}
+
+		SKMP_FORCEINLINE static void Record(Probe a_id, std::uint64_t a_ns) noexcept
+		{
+			m_probes[std::to_underlying(a_id)].Add(a_ns);
+		}
+
+		SKMP_FORCEINLINE static void CacheResult(Cache a_id, bool a_hit) noexcept
+		{
+			if (m_enabled)
+			{
+				auto& e = m_caches[std::to_underlying(a_id)];
+				(a_hit ? e.hits : e.misses).fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		SKMP_FORCEINLINE static void SetQueueDepth(std::size_t a_depth) noexcept
+		{
+			if (m_enabled)
+			{
+				m_queueDepth.store(a_depth, std::memory_order_relaxed);
+
+				auto peak = m_queuePeak.load(std::memory_order_relaxed);
+				while (a_depth > peak &&
+				       !m_queuePeak.compare_exchange_weak(peak, a_depth, std::memory_order_relaxed))
+				{
+				}
+			}
+		}
+
+		SKMP_FORCEINLINE static void SetMemoryUsage(std::size_t a_cacheBytes, std::size_t a_queueBytes) noexcept
+		{
+			if (m_enabled)
+			{
+				m_cacheBytes.store(a_cacheBytes, std::memory_order_relaxed);
+				m_queueBytes.store(a_queueBytes, std::memory_order_relaxed);
+			}
+		}
+
+		static void Start(std::uint32_t a_intervalMs);
+
+	private:
+		struct CacheCounters
+		{
+			std::atomic<std::uint64_t> hits{ 0 };
+			std::atomic<std::uint64_t> misses{ 0 };
+		};
+
+		static void WriterThread(std::uint32_t a_intervalMs);
+
+		static inline bool m_enabled{ false };
+
+		static inline std::atomic<std::uint64_t> m_counters[std::to_underlying(Counter::kMax)]{};
+		static inline LatencyHistogram m_probes[std::to_underlying(Probe::kMax)];
+		static inline CacheCounters m_caches[std::to_underlying(Cache::kMax)];
+		static inline std::atomic<std::size_t> m_queueDepth{ 0 };
+		static inline std::atomic<std::size_t> m_queuePeak{ 0 };
+		static inline std::atomic<std::size_t> m_cacheBytes{ 0 };
+		static inline std::atomic<std::size_t> m_queueBytes{ 0 };
+	};
+
+	class MetricsScope
+	{
+	public:
+		SKMP_FORCEINLINE MetricsScope(Metrics::Probe a_id) noexcept :
+			m_id(a_id),
+			m_enabled(Metrics::IsEnabled())
+		{
+			if (m_enabled)
+			{
+				m_start = std::chrono::steady_clock::now();
+			}
+		}
+
+		SKMP_FORCEINLINE ~MetricsScope() noexcept
+		{
+			if (m_enabled)
+			{
+				auto e = std::chrono::steady_clock::now() - m_start;
+				Metrics::Record(m_id, std::chrono::duration_cast<std::chrono::nanoseconds>(e).count());
+			}
+		}
+
+		// leaves a_ns of diagnostic work out of the recorded time
+		SKMP_FORCEINLINE void Exclude(std::uint64_t a_ns) noexcept
+		{
+			if (m_enabled)
+			{
+				m_start += std::chrono::nanoseconds(a_ns);
+			}
+		}
+
+		MetricsScope(const MetricsScope&) = delete;
+		MetricsScope& operator=(const MetricsScope&) = delete;
+
+	private:
+		Metrics::Probe m_id;
+		bool m_enabled;
+		std::chrono::steady_clock::time_point m_start;
+	};
+}
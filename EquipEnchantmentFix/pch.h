@@ -14,7 +14,31 @@
 
 #include <ShlObj.h>
 
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "eef_api.h"
+#include "metrics.h"
+#include "report_file.h"
+
+#include "actor_cache.h"
+#include "actor_filter.h"
 #include "eef.h"
+
+#include "actor_warmup.h"
+#include "cell_scheduler.h"
+#include "hook_control.h"
+#include "sched_benchmark.h"
+#include "shadow_verifier.h"
+#include "slow_op_log.h"
+#include "trace_profiler.h"
+
 #include "plugin.h"
 #include "skse.h"
 
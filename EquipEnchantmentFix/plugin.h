@@ -8,4 +8,6 @@
 #define MIN_RUNTIME_VERSION RUNTIME_VERSION_1_5_39
 
 #define PLUGIN_LOG_PATH "My Games\\Skyrim Special Edition\\SKSE\\" PLUGIN_NAME ".log"
+#define PLUGIN_METRICS_PATH "My Games\\Skyrim Special Edition\\SKSE\\" PLUGIN_NAME ".metrics.json"
+#define PLUGIN_TRACE_PATH "My Games\\Skyrim Special Edition\\SKSE\\" PLUGIN_NAME ".trace.json"
 #define PLUGIN_INI_FILE_NOEXT "Data\\SKSE\\Plugins\\" PLUGIN_NAME
@@ -0,0 +1,67 @@
+#include "pch.h"
+
+namespace EEF
+{
+	std::string ReportFile::GetPath(const char* a_relPath)
+	{
+		char path[MAX_PATH];
+
+		if (!SUCCEEDED(::SHGetFolderPathA(nullptr, CSIDL_MYDOCUMENTS | CSIDL_FLAG_CREATE, nullptr, SHGFP_TYPE_CURRENT, path)))
+		{
+			return {};
+		}
+
+		std::string result(path);
+		result += '\\';
+		result += a_relPath;
+
+		return result;
+	}
+
+	void ReportFile::AppendFormat(std::string& a_out, const char* a_fmt, ...)
+	{
+		char buffer[512];
+
+		va_list args;
+		va_start(args, a_fmt);
+		auto n = _vsnprintf_s(buffer, _TRUNCATE, a_fmt, args);
+		va_end(args);
+
+		if (n > 0)
+		{
+			a_out.append(buffer, static_cast<std::size_t>(n));
+		}
+	}
+
+	bool ReportFile::Write(const std::string& a_path, const std::string& a_data)
+	{
+		auto tmp = a_path + ".tmp";
+
+		auto handle = ::CreateFileA(
+			tmp.c_str(),
+			GENERIC_WRITE,
+			0,
+			nullptr,
+			CREATE_ALWAYS,
+			FILE_ATTRIBUTE_NORMAL,
+			nullptr);
+
+		if (handle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		DWORD written = 0;
+		bool ok = ::WriteFile(handle, a_data.data(), static_cast<DWORD>(a_data.size()), &written, nullptr) &&
+		          written == a_data.size();
+
+		::CloseHandle(handle);
+
+		if (!ok)
+		{
+			return false;
+		}
+
+		return ::MoveFileExA(tmp.c_str(), a_path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != FALSE;
+	}
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+namespace EEF
+{
+	// File helpers shared by the diagnostic writers (metrics snapshots, traces).
+	class ReportFile
+	{
+	public:
+		// a_relPath under My Documents, empty on failure
+		static std::string GetPath(const char* a_relPath);
+
+		static void AppendFormat(std::string& a_out, const char* a_fmt, ...);
+
+		// writes a temporary file and moves it over a_path, readers only ever see a complete file
+		static bool Write(const std::string& a_path, const std::string& a_data);
+	};
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+namespace EEF
+{
+	// Stresses the EnchantmentEnforcerTask queue without touching game state: producer
+	// threads call Add with random handles the way ScheduleEFT does, with task submission
+	// stubbed out, while a consumer drains it through the same critical section as Run
+	// once per simulated frame. Lock hold times come from the task's own debug timing
+	// hooks. Results go to the log. Debug builds only.
+	class SchedulerBenchmark
+	{
+	public:
+		struct Config
+		{
+			std::uint32_t producers;
+			std::uint32_t durationMs;
+			std::uint32_t handleSpace;  // distinct handles, controls the dedup rate
+			std::uint32_t frameMs;
+			std::uint32_t processNs;  // simulated ProcessActor cost per drained handle
+		};
+
+		// runs on a detached thread
+		static void Start(const Config& a_config);
+
+	private:
+		static void Run(Config a_config);
+	};
+}
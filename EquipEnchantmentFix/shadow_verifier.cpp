@@ -0,0 +1,53 @@
+#include "pch.h"
+
+namespace EEF
+{
+	void ShadowVerifier::Initialize(std::uint32_t a_sampleRate)
+	{
+		m_sampleRate = a_sampleRate;
+	}
+
+	void ShadowVerifier::Check(
+		const char* a_path,
+		const char* a_what,
+		Actor* a_actor,
+		TESForm* a_form,
+		bool a_fast,
+		bool a_reference)
+	{
+		m_checks.fetch_add(1, std::memory_order_relaxed);
+		Metrics::Inc(Metrics::Counter::kShadowChecks);
+
+		if (a_fast == a_reference)
+		{
+			return;
+		}
+
+		m_mismatches.fetch_add(1, std::memory_order_relaxed);
+		Metrics::Inc(Metrics::Counter::kShadowMismatches);
+
+		gLog.Warning(
+			"Shadow verify mismatch [%s]: actor %.8X, item %.8X, %s: fast=%d reference=%d",
+			a_path,
+			a_actor ? a_actor->formID : 0,
+			a_form ? a_form->formID : 0,
+			a_what,
+			a_fast,
+			a_reference);
+	}
+
+	void ShadowVerifier::LogSummary()
+	{
+		if (!m_sampleRate)
+		{
+			return;
+		}
+
+		gLog.Message(
+			"Shadow verify (1/%u): %llu checks, %llu mismatches, %.3f ms overhead",
+			m_sampleRate,
+			m_checks.load(std::memory_order_relaxed),
+			m_mismatches.load(std::memory_order_relaxed),
+			static_cast<double>(m_overhead.load(std::memory_order_relaxed)) / 1000000.0);
+	}
+}
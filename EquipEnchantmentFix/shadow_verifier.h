@@ -0,0 +1,44 @@
+#pragma once
+
+namespace EEF
+{
+	// Decides which calls on the optimized paths are re-checked against the reference
+	// inventory/effect scans, and reports any divergence.
+	class ShadowVerifier
+	{
+	public:
+		static void Initialize(std::uint32_t a_sampleRate);
+
+		[[nodiscard]] SKMP_FORCEINLINE static bool ShouldSample() noexcept
+		{
+			if (!m_sampleRate)
+			{
+				return false;
+			}
+
+			return m_counter.fetch_add(1, std::memory_order_relaxed) % m_sampleRate == 0;
+		}
+
+		static void Check(
+			const char* a_path,
+			const char* a_what,
+			Actor* a_actor,
+			TESForm* a_form,
+			bool a_fast,
+			bool a_reference);
+
+		static void AddOverhead(std::uint64_t a_ns) noexcept
+		{
+			m_overhead.fetch_add(a_ns, std::memory_order_relaxed);
+		}
+
+		static void LogSummary();
+
+	private:
+		static inline std::uint32_t m_sampleRate{ 0 };
+		static inline std::atomic<std::uint32_t> m_counter{ 0 };
+		static inline std::atomic<std::uint64_t> m_checks{ 0 };
+		static inline std::atomic<std::uint64_t> m_mismatches{ 0 };
+		static inline std::atomic<std::uint64_t> m_overhead{ 0 };
+	};
+}
@@ -0,0 +1,125 @@
+#include "pch.h"
+
+namespace EEF
+{
+	static constexpr const char* s_opNames[] = {
+		"ProcessActor",
+		"HandleEvent",
+		"EquipItem_Hook",
+		"DispelWornItemEnchants (inventory)",
+		"DispelWornItemEnchants (add/remove)"
+	};
+
+	static_assert(std::size(s_opNames) == std::to_underlying(SlowOpLog::Op::kMax));
+
+	void SlowOpLog::Start(std::uint32_t a_thresholdUs)
+	{
+		m_buffer.reserve(BUFFER_SIZE);
+		m_thresholdNs = static_cast<std::uint64_t>(a_thresholdUs) * 1000;
+
+		std::thread(FlushThread).detach();
+	}
+
+	void SlowOpLog::Capture(Op a_op, Actor* a_actor, std::uint64_t a_elapsedNs)
+	{
+		Record record{ a_op, 0, 0, 0, 0, a_elapsedNs };
+
+		if (a_actor)
+		{
+			record.formId = a_actor->formID;
+
+			auto containerChanges = a_actor->extraData.Get<ExtraContainerChanges>();
+			if (containerChanges &&
+			    containerChanges->data &&
+			    containerChanges->data->objList)
+			{
+				auto objList = containerChanges->data->objList;
+
+				for (auto it = objList->Begin(); !it.End(); ++it)
+				{
+					record.inventoryEntries++;
+
+					auto entry = *it;
+					if (!entry || !entry->extendDataList)
+						continue;
+
+					for (auto it2 = entry->extendDataList->Begin(); !it2.End(); ++it2)
+					{
+						record.extraLists++;
+					}
+				}
+			}
+
+			if (auto effects = a_actor->GetActiveEffectList())
+			{
+				for (auto& e : *effects)
+				{
+					if (e)
+						record.activeEffects++;
+				}
+			}
+		}
+
+		bool notify;
+
+		{
+			std::lock_guard lock(m_lock);
+
+			if (m_buffer.size() >= BUFFER_SIZE)
+			{
+				m_dropped++;
+				return;
+			}
+
+			m_buffer.emplace_back(record);
+
+			notify = m_buffer.size() >= BUFFER_SIZE / 2;
+		}
+
+		if (notify)
+		{
+			m_cond.notify_one();
+		}
+	}
+
+	void SlowOpLog::FlushThread()
+	{
+		std::vector<Record> pending;
+		pending.reserve(BUFFER_SIZE);
+
+		for (;;)
+		{
+			std::uint64_t dropped;
+
+			{
+				std::unique_lock lock(m_lock);
+
+				m_cond.wait_for(lock, std::chrono::seconds(1), [] {
+					return m_buffer.size() >= BUFFER_SIZE / 2;
+				});
+
+				pending.swap(m_buffer);
+				dropped = std::exchange(m_dropped, 0);
+			}
+
+			for (auto& e : pending)
+			{
+				gLog.Warning(
+					"Slow %s: %.3f ms, actor %.8X, inventory entries %u, extra lists %u, active effects %u",
+					s_opNames[std::to_underlying(e.op)],
+					static_cast<double>(e.elapsedNs) / 1000000.0,
+					e.formId,
+					e.inventoryEntries,
+					e.extraLists,
+					e.activeEffects);
+			}
+
+			if (dropped)
+			{
+				gLog.Warning("Slow operation buffer full, %llu records dropped", dropped);
+			}
+
+			pending.clear();
+		}
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+namespace EEF
+{
+	// Captures calls exceeding a time threshold together with the actor's inventory and
+	// effect list sizes, and writes them to the log from a background thread.
+	class SlowOpLog
+	{
+		static constexpr std::size_t BUFFER_SIZE = 256;
+
+	public:
+		enum class Op : std::uint32_t
+		{
+			kProcessActor,
+			kEquipEvent,
+			kEquipItem,
+			kDispelInventory,
+			kDispelAddRemove,
+
+			kMax
+		};
+
+		struct Record
+		{
+			Op op;
+			std::uint32_t formId;
+			std::uint32_t inventoryEntries;
+			std::uint32_t extraLists;
+			std::uint32_t activeEffects;
+			std::uint64_t elapsedNs;
+		};
+
+		static void Start(std::uint32_t a_thresholdUs);
+
+		[[nodiscard]] SKMP_FORCEINLINE static std::uint64_t GetThreshold() noexcept
+		{
+			return m_thresholdNs;
+		}
+
+		// called on the thread that owns a_actor's data, right after the slow call
+		static void Capture(Op a_op, Actor* a_actor, std::uint64_t a_elapsedNs);
+
+	private:
+		static void FlushThread();
+
+		static inline std::uint64_t m_thresholdNs{ 0 };
+
+		static inline std::mutex m_lock;
+		static inline std::condition_variable m_cond;
+		static inline std::vector<Record> m_buffer;
+		static inline std::uint64_t m_dropped{ 0 };
+	};
+
+	class SlowOpScope
+	{
+	public:
+		SKMP_FORCEINLINE SlowOpScope(SlowOpLog::Op a_op, Actor* a_actor) noexcept :
+			m_op(a_op),
+			m_actor(a_actor)
+		{
+			if (SlowOpLog::GetThreshold())
+			{
+				m_start = std::chrono::steady_clock::now();
+			}
+		}
+
+		SKMP_FORCEINLINE ~SlowOpScope() noexcept
+		{
+			if (auto threshold = SlowOpLog::GetThreshold())
+			{
+				auto e = std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - m_start);
+
+				if (static_cast<std::uint64_t>(e.count()) > threshold)
+				{
+					SlowOpLog::Capture(m_op, m_actor, e.count());
+				}
+			}
+		}
+
+		SKMP_FORCEINLINE void Exclude(std::uint64_t a_ns) noexcept
+		{
+			if (SlowOpLog::GetThreshold())
+			{
+				m_start += std::chrono::nanoseconds(a_ns);
+			}
+		}
+
+		SlowOpScope(const SlowOpScope&) = delete;
+		SlowOpScope& operator=(const SlowOpScope&) = delete;
+
+	private:
+		SlowOpLog::Op m_op;
+		Actor* m_actor;
+		std::chrono::steady_clock::time_point m_start;
+	};
+}
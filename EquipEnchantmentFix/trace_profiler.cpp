@@ -0,0 +1,219 @@
+#include "pch.h"
+
+namespace EEF
+{
+	static constexpr const char* s_spanNames[] = {
+		"TaskRun",
+		"ProcessActor",
+		"InventoryVisit",
+		"EffectScan",
+		"UpdateArmorAbility",
+		"Dispel",
+		"EquipEvent",
+		"Warmup",
+		"ShadowVerify"
+	};
+
+	static_assert(std::size(s_spanNames) == std::to_underlying(TraceProfiler::Span::kMax));
+
+	void TraceProfiler::Initialize(std::uint32_t a_captureMs)
+	{
+		m_captureMs = a_captureMs;
+		m_mainThreadId = ::GetCurrentThreadId();
+	}
+
+	void TraceProfiler::BeginCapture()
+	{
+		if (!m_captureMs)
+		{
+			return;
+		}
+
+		std::uint64_t generation;
+
+		{
+			std::lock_guard lock(m_lock);
+
+			// spans are matched to a window by generation, publish the origin first
+			m_origin.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+			generation = m_generation.fetch_add(1, std::memory_order_release) + 1;
+
+			m_capturing.store(true, std::memory_order_relaxed);
+		}
+
+		std::thread(WriterThread, generation).detach();
+	}
+
+	auto TraceProfiler::GetThreadBuffer()
+		-> ThreadBuffer&
+	{
+		thread_local std::shared_ptr<ThreadBuffer> buffer;
+
+		if (!buffer)
+		{
+			buffer = std::make_shared<ThreadBuffer>();
+
+			std::lock_guard lock(m_lock);
+			m_buffers.emplace_back(buffer);
+		}
+
+		return *buffer;
+	}
+
+	void TraceProfiler::Record(
+		Span a_span,
+		Actor* a_actor,
+		std::chrono::steady_clock::time_point a_start,
+		std::chrono::steady_clock::time_point a_end)
+	{
+		auto& buffer = GetThreadBuffer();
+
+		auto generation = m_generation.load(std::memory_order_acquire);
+
+		if (!m_capturing.load(std::memory_order_relaxed) ||
+		    a_start.time_since_epoch().count() < m_origin.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		std::lock_guard lock(buffer.lock);
+
+		// first span of a new window on this thread, anything left over is stale
+		if (buffer.generation != generation)
+		{
+			buffer.events.clear();
+			buffer.generation = generation;
+			buffer.dropped = 0;
+		}
+
+		if (buffer.events.size() >= MAX_THREAD_EVENTS)
+		{
+			buffer.dropped++;
+			return;
+		}
+
+		buffer.events.emplace_back(Event{
+			a_span,
+			::GetCurrentThreadId(),
+			a_actor ? a_actor->formID : 0,
+			a_start,
+			a_end });
+	}
+
+	void TraceProfiler::WriterThread(std::uint64_t a_generation)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(m_captureMs));
+
+		std::vector<Event> events;
+		std::chrono::steady_clock::time_point origin;
+		std::uint64_t dropped = 0;
+
+		{
+			std::lock_guard lock(m_lock);
+
+			// superseded by a later load
+			if (a_generation != m_generation.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			m_capturing.store(false, std::memory_order_relaxed);
+
+			origin = std::chrono::steady_clock::time_point(
+				std::chrono::steady_clock::duration(m_origin.load(std::memory_order_relaxed)));
+
+			for (auto it = m_buffers.begin(); it != m_buffers.end();)
+			{
+				auto& buffer = **it;
+
+				{
+					std::lock_guard block(buffer.lock);
+
+					if (buffer.generation == a_generation)
+					{
+						events.insert(events.end(), buffer.events.begin(), buffer.events.end());
+						dropped += buffer.dropped;
+					}
+
+					decltype(buffer.events)().swap(buffer.events);
+					buffer.dropped = 0;
+				}
+
+				// the owning thread has exited
+				if (it->use_count() == 1)
+				{
+					it = m_buffers.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+
+		std::sort(
+			events.begin(),
+			events.end(),
+			[](auto& a_lhs, auto& a_rhs) {
+				return a_lhs.start < a_rhs.start;
+			});
+
+		if (Write(events, origin))
+		{
+			gLog.Message(
+				"Trace written: %zu spans over %u ms, %llu dropped",
+				events.size(),
+				m_captureMs,
+				dropped);
+		}
+		else
+		{
+			gLog.Warning("Failed to write the trace file");
+		}
+	}
+
+	bool TraceProfiler::Write(
+		const std::vector<Event>& a_events,
+		std::chrono::steady_clock::time_point a_origin)
+	{
+		auto path = ReportFile::GetPath(PLUGIN_TRACE_PATH);
+		if (path.empty())
+		{
+			return false;
+		}
+
+		auto pid = ::GetCurrentProcessId();
+
+		std::string out;
+		out.reserve(a_events.size() * 160 + 512);
+
+		ReportFile::AppendFormat(
+			out,
+			"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+			"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"" PLUGIN_NAME "\"}},\n"
+			"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"Main\"}}",
+			pid,
+			pid,
+			m_mainThreadId);
+
+		for (auto& e : a_events)
+		{
+			auto ts = std::chrono::duration<double, std::micro>(e.start - a_origin).count();
+			auto dur = std::chrono::duration<double, std::micro>(e.end - e.start).count();
+
+			ReportFile::AppendFormat(
+				out,
+				",\n{\"name\":\"%s\",\"cat\":\"eef\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u,\"args\":{\"actor\":\"%.8X\"}}",
+				s_spanNames[std::to_underlying(e.span)],
+				ts,
+				dur,
+				pid,
+				e.threadId,
+				e.formId);
+		}
+
+		out += "\n]}\n";
+
+		return ReportFile::Write(path, out);
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+namespace EEF
+{
+	// Records scoped spans for a fixed window after each load and writes them out in
+	// Chrome trace-event format (chrome://tracing, Perfetto). Each thread appends to its
+	// own buffer, the buffers are merged once the window closes.
+	class TraceProfiler
+	{
+		static constexpr std::size_t MAX_THREAD_EVENTS = 1 << 16;
+
+	public:
+		enum class Span : std::uint32_t
+		{
+			kTaskRun,
+			kProcessActor,
+			kInventoryVisit,
+			kEffectScan,
+			kUpdateArmorAbility,
+			kDispel,
+			kEquipEvent,
+			kWarmup,
+			kShadowVerify,
+
+			kMax
+		};
+
+		struct Event
+		{
+			Span span;
+			std::uint32_t threadId;
+			std::uint32_t formId;
+			std::chrono::steady_clock::time_point start;
+			std::chrono::steady_clock::time_point end;
+		};
+
+		static void Initialize(std::uint32_t a_captureMs);
+
+		[[nodiscard]] SKMP_FORCEINLINE static bool IsCapturing() noexcept
+		{
+			return m_capturing.load(std::memory_order_relaxed);
+		}
+
+		// discards any capture in progress and opens a new window
+		static void BeginCapture();
+
+		static void Record(
+			Span a_span,
+			Actor* a_actor,
+			std::chrono::steady_clock::time_point a_start,
+			std::chrono::steady_clock::time_point a_end);
+
+	private:
+		// only contended by the writer thread while it collects the buffer
+		struct ThreadBuffer
+		{
+			std::mutex lock;
+			std::vector<Event> events;
+			std::uint64_t generation{ 0 };
+			std::uint64_t dropped{ 0 };
+		};
+
+		static ThreadBuffer& GetThreadBuffer();
+
+		static void WriterThread(std::uint64_t a_generation);
+		static bool Write(
+			const std::vector<Event>& a_events,
+			std::chrono::steady_clock::time_point a_origin);
+
+		static inline std::uint32_t m_captureMs{ 0 };
+		static inline std::uint32_t m_mainThreadId{ 0 };
+		static inline std::atomic<bool> m_capturing{ false };
+		static inline std::atomic<std::uint64_t> m_generation{ 0 };
+		static inline std::atomic<std::chrono::steady_clock::rep> m_origin{ 0 };
+
+		// guards m_buffers and capture start/stop, never taken per span
+		static inline std::mutex m_lock;
+		static inline std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+	};
+
+	class TraceScope
+	{
+	public:
+		SKMP_FORCEINLINE TraceScope(TraceProfiler::Span a_span, Actor* a_actor) noexcept :
+			m_span(a_span),
+			m_actor(a_actor),
+			m_active(TraceProfiler::IsCapturing())
+		{
+			if (m_active)
+			{
+				m_start = std::chrono::steady_clock::now();
+			}
+		}
+
+		SKMP_FORCEINLINE ~TraceScope() noexcept
+		{
+			if (m_active)
+			{
+				TraceProfiler::Record(m_span, m_actor, m_start, std::chrono::steady_clock::now());
+			}
+		}
+
+		TraceScope(const TraceScope&) = delete;
+		TraceScope& operator=(const TraceScope&) = delete;
+
+	private:
+		TraceProfiler::Span m_span;
+		Actor* m_actor;
+		bool m_active;
+		std::chrono::steady_clock::time_point m_start;
+	};
+}